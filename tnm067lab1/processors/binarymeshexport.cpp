@@ -0,0 +1,43 @@
+#include <modules/tnm067lab1/processors/binarymeshexport.h>
+#include <modules/tnm067lab1/utils/meshio.h>
+#include <inviwo/core/util/logcentral.h>
+
+namespace inviwo {
+
+const ProcessorInfo BinaryMeshExport::processorInfo_{
+    "org.inviwo.BinaryMeshExport",  // Class identifier
+    "Binary Mesh Export",           // Display name
+    "TNM067",                       // Category
+    CodeState::Experimental,        // Code state
+    Tags::CPU,                      // Tags
+};
+const ProcessorInfo BinaryMeshExport::getProcessorInfo() const { return processorInfo_; }
+
+BinaryMeshExport::BinaryMeshExport()
+    : Processor()
+    , inport_("inport")
+    , file_("file", "File")
+    , format_("format", "Format",
+              {{"ply", "Binary PLY", Format::PLY}, {"raw", "Raw Mesh", Format::Raw}})
+    , export_("export", "Export") {
+
+    addPort(inport_);
+    addProperty(file_);
+    addProperty(format_);
+    addProperty(export_);
+
+    export_.onChange([this]() { exportMesh(); });
+}
+
+void BinaryMeshExport::exportMesh() {
+    const auto mesh = inport_.getData();
+    if (!mesh || file_.get().empty()) return;
+
+    const bool written = format_ == Format::PLY ? meshio::writePLY(*mesh, file_.get())
+                                                : meshio::writeRaw(*mesh, file_.get());
+    if (!written) {
+        LogError("Failed to write " << file_.get());
+    }
+}
+
+}  // namespace inviwo
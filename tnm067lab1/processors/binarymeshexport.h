@@ -0,0 +1,35 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/properties/fileproperty.h>
+#include <inviwo/core/properties/buttonproperty.h>
+#include <inviwo/core/ports/meshport.h>
+
+namespace inviwo {
+
+/**
+ * \class BinaryMeshExport
+ * \brief Writes the input mesh as binary PLY or in the raw mesh format, see meshio
+ */
+class IVW_MODULE_TNM067LAB1_API BinaryMeshExport : public Processor {
+public:
+    enum class Format { PLY, Raw };
+
+    BinaryMeshExport();
+    virtual ~BinaryMeshExport() = default;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+private:
+    void exportMesh();
+
+    MeshInport inport_;
+    FileProperty file_;
+    OptionProperty<Format> format_;
+    ButtonProperty export_;
+};
+
+}  // namespace inviwo
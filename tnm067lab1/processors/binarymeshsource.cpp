@@ -0,0 +1,33 @@
+#include <modules/tnm067lab1/processors/binarymeshsource.h>
+#include <modules/tnm067lab1/utils/meshio.h>
+#include <inviwo/core/util/exception.h>
+#include <inviwo/core/util/logcentral.h>
+
+namespace inviwo {
+
+const ProcessorInfo BinaryMeshSource::processorInfo_{
+    "org.inviwo.BinaryMeshSource",  // Class identifier
+    "Binary Mesh Source",           // Display name
+    "TNM067",                       // Category
+    CodeState::Experimental,        // Code state
+    Tags::CPU,                      // Tags
+};
+const ProcessorInfo BinaryMeshSource::getProcessorInfo() const { return processorInfo_; }
+
+BinaryMeshSource::BinaryMeshSource()
+    : Processor(), outport_("outport"), file_("file", "File") {
+
+    addPort(outport_);
+    addProperty(file_);
+}
+
+void BinaryMeshSource::process() {
+    try {
+        outport_.setData(meshio::readRaw(file_.get()));
+    } catch (const Exception& e) {
+        LogError("Failed to read " << file_.get() << ": " << e.getMessage());
+        outport_.setData(nullptr);
+    }
+}
+
+}  // namespace inviwo
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/fileproperty.h>
+#include <inviwo/core/ports/meshport.h>
+
+namespace inviwo {
+
+/**
+ * \class BinaryMeshSource
+ * \brief Loads a mesh written in the raw mesh format by BinaryMeshExport, see meshio::readRaw
+ */
+class IVW_MODULE_TNM067LAB1_API BinaryMeshSource : public Processor {
+public:
+    BinaryMeshSource();
+    virtual ~BinaryMeshSource() = default;
+
+    virtual void process() override;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+private:
+    MeshOutport outport_;
+    FileProperty file_;
+};
+
+}  // namespace inviwo
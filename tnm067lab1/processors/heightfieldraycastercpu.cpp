@@ -0,0 +1,128 @@
+#include <modules/tnm067lab1/processors/heightfieldraycastercpu.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <modules/tnm067lab1/utils/heightfieldraycast.h>
+#include <modules/tnm067lab1/utils/parallelutils.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+
+#include <algorithm>
+
+namespace inviwo {
+
+const ProcessorInfo HeightfieldRaycasterCPU::processorInfo_{
+    "org.inviwo.HeightfieldRaycasterCPU",  // Class identifier
+    "Heightfield Raycaster CPU",           // Display name
+    "TNM067",                              // Category
+    CodeState::Experimental,               // Code state
+    Tags::CPU,                             // Tags
+};
+const ProcessorInfo HeightfieldRaycasterCPU::getProcessorInfo() const { return processorInfo_; }
+
+HeightfieldRaycasterCPU::HeightfieldRaycasterCPU()
+    : Processor()
+    , imageInport_("imageInport", true)
+    , outport_("outport", true)
+    , heightScaleFactor_("heightScaleFactor", "Height Scale Factor", 1.0f, 0.001f, 2.0f, 0.001f)
+    , camera_("camera", "Camera", vec3(0.5f, 1.5f, 2.0f), vec3(0.5f, 0.0f, 0.5f),
+              vec3(0.0f, 1.0f, 0.0f))
+    , trackball_(&camera_)
+    , numColors_("numColors", "Number of colors", 2, 1, 10)
+    , colors_({FloatVec4Property{"color1", "Color 1", vec4(0, 0, 0, 1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color2", "Color 2", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color3", "Color 3", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color4", "Color 4", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color5", "Color 5", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color6", "Color 6", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color7", "Color 7", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color8", "Color 8", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color9", "Color 9", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color10", "Color 10", vec4(1), vec4(0, 0, 0, 1), vec4(1)}}) {
+
+    addPort(imageInport_);
+    addPort(outport_);
+    addProperty(heightScaleFactor_);
+    addProperty(camera_);
+    addProperty(trackball_);
+
+    addProperty(numColors_);
+    for (auto& c : colors_) {
+        c.setSemantics(PropertySemantics::Color);
+        c.setCurrentStateAsDefault();
+        addProperty(c);
+    }
+
+    auto colorVisibility = [&]() {
+        for (size_t i = 0; i < 10; i++) {
+            colors_[i].setVisible(i < numColors_);
+        }
+    };
+
+    numColors_.onChange(colorVisibility);
+    colorVisibility();
+}
+
+namespace {
+
+constexpr size_t tileSize = 32;
+
+}  // namespace
+
+void HeightfieldRaycasterCPU::process() {
+    // The mipmap only depends on the image and the scale, camera and color changes reuse it
+    if (imageInport_.isChanged() || heightScaleFactor_.isModified() || mipmap_.levels.empty()) {
+        const auto layer = imageInport_.getData()->getColorLayer()->getRepresentation<LayerRAM>();
+        inDims_ = layer->getDimensions();
+        values_ = heightfield::readValues(*layer);
+
+        std::vector<float> heights(values_.size());
+        std::transform(values_.begin(), values_.end(), heights.begin(),
+                       [scale = heightScaleFactor_.get()](float v) { return v * scale; });
+        baseHeight_ = heightfield::heightRange(values_, heightScaleFactor_).x;
+        mipmap_ = heightfield::MaxMipmap(std::move(heights), ivec2(inDims_));
+    }
+
+    ScalarToColorMapping map;
+    for (size_t i = 0; i < numColors_.get(); i++) {
+        map.addBaseColors(colors_[i].get());
+    }
+
+    const size2_t outDims = outport_.getDimensions();
+    auto img = std::make_shared<Image>(outDims, DataVec4UInt8::get());
+    auto outRep = static_cast<LayerRAMPrecision<glm::u8vec4>*>(
+        img->getColorLayer()->getEditableRepresentation<LayerRAM>());
+    glm::u8vec4* outPixels = outRep->getDataTyped();
+
+    const auto& camera = camera_.get();
+    const mat4 toWorld = camera.getInverseViewMatrix() * camera.getInverseProjectionMatrix();
+    auto unproject = [&](const vec2& ndc, float depth) {
+        const vec4 p = toWorld * vec4(ndc, depth, 1.0f);
+        return vec3(p) / p.w;
+    };
+
+    const size2_t tiles = (outDims + size2_t(tileSize - 1)) / tileSize;
+    util::forEachJobParallel(tiles.x * tiles.y, [&](size_t tile) {
+        const size2_t begin = size2_t(tile % tiles.x, tile / tiles.x) * tileSize;
+        const size2_t end = glm::min(begin + size2_t(tileSize), outDims);
+        for (size_t y = begin.y; y < end.y; ++y) {
+            for (size_t x = begin.x; x < end.x; ++x) {
+                const vec2 ndc = 2.0f * (vec2(x, y) + 0.5f) / vec2(outDims) - 1.0f;
+                const vec3 origin = unproject(ndc, -1.0f);
+                const vec3 dir = glm::normalize(unproject(ndc, 1.0f) - origin);
+
+                vec4 color(0.0f);
+                heightfield::RayHit hit;
+                if (heightfield::castRay(mipmap_, baseHeight_, origin, dir, hit)) {
+                    // Headlight shading of the cell color
+                    color = map.sample(values_[hit.cell.x + hit.cell.y * inDims_.x]);
+                    const float light = 0.3f + 0.7f * std::max(0.0f, -glm::dot(hit.normal, dir));
+                    color = vec4(vec3(color) * light, color.a);
+                }
+                outPixels[x + y * outDims.x] = glm::u8vec4(glm::clamp(color, 0.0f, 1.0f) * 255.f);
+            }
+        }
+    });
+
+    outport_.setData(img);
+}
+
+}  // namespace inviwo
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/cameraproperty.h>
+#include <inviwo/core/interaction/cameratrackball.h>
+#include <inviwo/core/ports/imageport.h>
+#include <modules/tnm067lab1/utils/heightfieldraycast.h>
+
+#include <array>
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \class HeightfieldRaycasterCPU
+ * \brief Renders the box heightfield of ImageToHeightfield directly from the image on the CPU
+ * Rays are traversed through a maximum mipmap of the heights, skipping every cell at a level
+ * whose maximum height is below the ray, so the cost per pixel grows with the logarithm of the
+ * image size. The output is split into tiles that are rendered in parallel.
+ */
+class IVW_MODULE_TNM067LAB1_API HeightfieldRaycasterCPU : public Processor {
+public:
+    HeightfieldRaycasterCPU();
+    virtual ~HeightfieldRaycasterCPU() = default;
+
+    virtual void process() override;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+private:
+    ImageInport imageInport_;
+    ImageOutport outport_;
+
+    FloatProperty heightScaleFactor_;
+    CameraProperty camera_;
+    CameraTrackball trackball_;
+
+    IntSizeTProperty numColors_;
+    std::array<FloatVec4Property, 10> colors_;
+
+    // Image values and the mipmap of their scaled heights, rebuilt when the image or the scale
+    // changes
+    std::vector<float> values_;
+    size2_t inDims_{0};
+    float baseHeight_ = 0.0f;
+    heightfield::MaxMipmap mipmap_;
+};
+
+}  // namespace inviwo
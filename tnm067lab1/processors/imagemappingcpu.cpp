@@ -1,9 +1,15 @@
 #include <modules/tnm067lab1/processors/imagemappingcpu.h>
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <modules/tnm067lab1/utils/indexedimage.h>
 #include <inviwo/core/common/inviwoapplication.h>
 #include <inviwo/core/datastructures/image/layerramprecision.h>
 #include <inviwo/core/util/indexmapper.h>
 #include <inviwo/core/util/imageramutils.h>
+#include <inviwo/core/util/glmutils.h>
+#include <inviwo/core/util/glmconvert.h>
+#include <inviwo/core/util/logcentral.h>
+
+#include <algorithm>
 
 
 namespace inviwo {
@@ -22,6 +28,14 @@ ImageMappingCPU::ImageMappingCPU()
     : Processor()
     , inport_("inport", true)
     , outport_("outport", false)
+    , outputFormat_("outputFormat", "Output Format",
+                    {{"rgba", "RGBA", OutputFormat::RGBA},
+                     {"indexed", "Palette Indexed (8 bit)", OutputFormat::Indexed}})
+    , vectorReduction_("vectorReduction", "Vector Reduction",
+                       {{"magnitude", "Magnitude", VectorReduction::Magnitude},
+                        {"component", "Component", VectorReduction::Component},
+                        {"maxComponent", "Max Component", VectorReduction::MaxComponent}})
+    , component_("component", "Component", 0, 0, 3)
     , numColors_("numColors", "Number of colors", 2, 1, 10)
     , colors_({FloatVec4Property{"color1", "Color 1", vec4(0, 0, 0, 1), vec4(0, 0, 0, 1), vec4(1)},
                FloatVec4Property{"color2", "Color 2", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
@@ -37,6 +51,12 @@ ImageMappingCPU::ImageMappingCPU()
     addPort(inport_);
     addPort(outport_);
 
+    addProperty(outputFormat_);
+    addProperty(vectorReduction_);
+    addProperty(component_);
+    component_.visibilityDependsOn(vectorReduction_, [](const auto& p) {
+        return p.get() == VectorReduction::Component;
+    });
     addProperty(numColors_);
     for (auto& c : colors_) {
         c.setSemantics(PropertySemantics::Color);
@@ -54,29 +74,100 @@ ImageMappingCPU::ImageMappingCPU()
     colorVisibility();
 }
 
+namespace {
+
+// Reduces a normalized vector to a scalar, scalars are passed through
+template <typename T>
+float reduce(const T& v, ImageMappingCPU::VectorReduction reduction, size_t component) {
+    constexpr size_t N = util::extent<T>::value;
+    if constexpr (N == 1) {
+        return util::glm_convert_normalized<float>(v);
+    } else {
+        const auto f = util::glm_convert_normalized<typename util::same_extent<T, float>::type>(v);
+        switch (reduction) {
+            case ImageMappingCPU::VectorReduction::Component:
+                return f[static_cast<glm::length_t>(std::min(component, N - 1))];
+            case ImageMappingCPU::VectorReduction::MaxComponent: {
+                float res = f[0];
+                for (glm::length_t c = 1; c < static_cast<glm::length_t>(N); ++c) {
+                    res = std::max(res, f[c]);
+                }
+                return res;
+            }
+            case ImageMappingCPU::VectorReduction::Magnitude:
+            default:
+                return glm::length(f);
+        }
+    }
+}
+
+// Calls callback(index, value) in parallel for each pixel, with value normalized to [0,1].
+// Vector pixels are reduced to a scalar inside the loop, no intermediate image is created.
+template <typename Callback>
+void forEachNormalizedPixel(const LayerRAM& layer, ImageMappingCPU::VectorReduction reduction,
+                            size_t component, Callback callback) {
+    util::IndexMapper2D index(layer.getDimensions());
+    layer.dispatch<void>([&](const auto inRep) {
+        auto inPixels = inRep->getDataTyped();
+        util::forEachPixelParallel(*inRep, [&](size2_t pos) {
+            auto i = index(pos);
+            callback(i, reduce(inPixels[i], reduction, component));
+        });
+    });
+}
+
+}  // namespace
+
 void ImageMappingCPU::process() {
     auto inImg = inport_.getData();
-    auto img = std::make_shared<Image>(inImg->getDimensions(), DataVec4UInt8::get());
-    auto outRep = static_cast<LayerRAMPrecision<glm::u8vec4>*>(
-        img->getColorLayer()->getEditableRepresentation<LayerRAM>());
-    glm::u8vec4* outPixels = outRep->getDataTyped();
-    util::IndexMapper2D index(inImg->getDimensions());
+    const auto inLayer = inImg->getColorLayer()->getRepresentation<LayerRAM>();
+
+    const auto reduction = vectorReduction_.get();
+    const auto component = component_.get();
 
     ScalarToColorMapping map;
     for (size_t i = 0; i < numColors_.get(); i++) {
         map.addBaseColors(colors_[i].get());
     }
 
-    inImg->getColorLayer()->getRepresentation<LayerRAM>()->dispatch<void>([&](const auto inRep) {
-        auto inPixels = inRep->getDataTyped();
-        util::forEachPixelParallel(*inRep, [&](size2_t pos) {
-            auto i = index(pos);
-            float inPixelVal = util::glm_convert_normalized<float>(inPixels[i]);
-            outPixels[i] = map.sample(inPixelVal) * 255.f;
+    if (outputFormat_ == OutputFormat::Indexed) {
+        const auto format = inImg->getDataFormat();
+        if ((inport_.isChanged() || outputFormat_.isModified()) &&
+            format->getSize() / format->getComponents() > 1) {
+            LogWarn("The palette has " << util::paletteSize << " entries, the "
+                                       << format->getString() << " input is quantized to 8 bits");
+        }
+        auto img = std::make_shared<Image>(inImg->getDimensions(), DataUInt8::get());
+        img->getColorLayer()->setSwizzleMask(swizzlemasks::luminance);
+        auto outRep = static_cast<LayerRAMPrecision<unsigned char>*>(
+            img->getColorLayer()->getEditableRepresentation<LayerRAM>());
+        unsigned char* outIndices = outRep->getDataTyped();
+
+        forEachNormalizedPixel(*inLayer, reduction, component, [&](size_t i, float inPixelVal) {
+            outIndices[i] = util::paletteIndex(inPixelVal);
         });
-    });
+
+        util::setPalette(*img, util::createPalette(map));
+        outport_.setData(img);
+        return;
+    }
+
+    auto img = std::make_shared<Image>(inImg->getDimensions(), DataVec4UInt8::get());
+    auto outRep = static_cast<LayerRAMPrecision<glm::u8vec4>*>(
+        img->getColorLayer()->getEditableRepresentation<LayerRAM>());
+    glm::u8vec4* outPixels = outRep->getDataTyped();
+
+    mapToRGBA(*inLayer, outPixels, map, reduction, component);
 
     outport_.setData(img);
 }
 
+void ImageMappingCPU::mapToRGBA(const LayerRAM& layer, glm::u8vec4* outPixels,
+                                const ScalarToColorMapping& map, VectorReduction reduction,
+                                size_t component) {
+    forEachNormalizedPixel(layer, reduction, component, [&](size_t i, float inPixelVal) {
+        outPixels[i] = map.sample(inPixelVal) * 255.f;
+    });
+}
+
 }  // namespace inviwo
@@ -3,17 +3,43 @@
 #include <modules/tnm067lab1/tnm067lab1moduledefine.h>
 #include <inviwo/core/processors/processor.h>
 #include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
 #include <inviwo/core/ports/imageport.h>
+#include <inviwo/core/datastructures/image/layerram.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
 
 namespace inviwo {
 
 class IVW_MODULE_TNM067LAB1_API ImageMappingCPU : public Processor {
 public:
+    /**
+     * RGBA outputs a DataVec4UInt8 image, Indexed outputs a DataUInt8 image of palette indices
+     * with the palette attached as meta data, see util::expandIndexedImage. The palette has 256
+     * entries, so Indexed quantizes the mapped values to 8 bits. Inputs with more than 8 bits per
+     * component lose precision and a warning is logged for them.
+     */
+    enum class OutputFormat { RGBA, Indexed };
+    /**
+     * Reduction applied to vec2/vec3/vec4 input pixels to get the scalar that is mapped.
+     * Magnitude is the euclidean length of the normalized components.
+     */
+    enum class VectorReduction { Magnitude, Component, MaxComponent };
+
     ImageMappingCPU();
     virtual ~ImageMappingCPU() = default;
 
     virtual void process() override;
 
+    /**
+     * Maps each pixel of \p layer to a color using \p map and writes it to \p outPixels, which
+     * must hold one element per pixel. Vector pixels are reduced using \p reduction.
+     * Runs in parallel on the thread pool.
+     */
+    static void mapToRGBA(const LayerRAM& layer, glm::u8vec4* outPixels,
+                          const ScalarToColorMapping& map,
+                          VectorReduction reduction = VectorReduction::Magnitude,
+                          size_t component = 0);
+
     virtual const ProcessorInfo getProcessorInfo() const override;
     static const ProcessorInfo processorInfo_;
 
@@ -21,6 +47,10 @@ private:
     ImageInport inport_;
     ImageOutport outport_;
 
+    OptionProperty<OutputFormat> outputFormat_;
+    OptionProperty<VectorReduction> vectorReduction_;
+    IntSizeTProperty component_;
+
     IntSizeTProperty numColors_;
     std::array<FloatVec4Property, 10> colors_;
 };
@@ -0,0 +1,147 @@
+#include <modules/tnm067lab1/processors/imagesequencemappingcpu.h>
+#include <modules/tnm067lab1/processors/imagemappingcpu.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+
+#include <algorithm>
+#include <utility>
+
+namespace inviwo {
+
+const ProcessorInfo ImageSequenceMappingCPU::processorInfo_{
+    "org.inviwo.ImageSequenceMappingCPU",  // Class identifier
+    "Image Sequence Mapping CPU",          // Display name
+    "TNM067",                              // Category
+    CodeState::Experimental,               // Code state
+    Tags::CPU,                             // Tags
+};
+const ProcessorInfo ImageSequenceMappingCPU::getProcessorInfo() const { return processorInfo_; }
+
+ImageSequenceMappingCPU::ImageSequenceMappingCPU()
+    : Processor()
+    , inport_("inport")
+    , outport_("outport", false)
+    , frame_("frame", "Frame", 0, 0, 0)
+    , numColors_("numColors", "Number of colors", 2, 1, 10)
+    , colors_({FloatVec4Property{"color1", "Color 1", vec4(0, 0, 0, 1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color2", "Color 2", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color3", "Color 3", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color4", "Color 4", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color5", "Color 5", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color6", "Color 6", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color7", "Color 7", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color8", "Color 8", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color9", "Color 9", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color10", "Color 10", vec4(1), vec4(0, 0, 0, 1), vec4(1)}}) {
+
+    addPort(inport_);
+    addPort(outport_);
+    addProperty(frame_);
+
+    inport_.onChange([this]() {
+        resetPipeline();
+        frames_.clear();
+        if (inport_.hasData()) frames_ = *inport_.getData();
+        frame_.setMaxValue(frames_.empty() ? 0 : frames_.size() - 1);
+    });
+
+    addProperty(numColors_);
+    numColors_.onChange([this]() { resetPipeline(); });
+    for (auto& c : colors_) {
+        c.setSemantics(PropertySemantics::Color);
+        c.setCurrentStateAsDefault();
+        c.onChange([this]() { resetPipeline(); });
+        addProperty(c);
+    }
+
+    auto colorVisibility = [&]() {
+        for (size_t i = 0; i < 10; i++) {
+            colors_[i].setVisible(i < numColors_);
+        }
+    };
+
+    numColors_.onChange(colorVisibility);
+    colorVisibility();
+}
+
+ImageSequenceMappingCPU::~ImageSequenceMappingCPU() { resetPipeline(); }
+
+void ImageSequenceMappingCPU::resetPipeline() {
+    if (mapping_.valid()) mapping_.wait();
+    mappedFrame_ = noFrame;
+    loadedFrame_ = noFrame;
+    loadedLayer_ = nullptr;
+}
+
+std::shared_ptr<Image> ImageSequenceMappingCPU::getBuffer(size_t frame, size2_t dims) {
+    // A buffer that is still referenced elsewhere, by the outport or by a downstream processor,
+    // is replaced rather than overwritten
+    auto& buffer = buffers_[frame % numBuffers];
+    if (!buffer || buffer.use_count() > 1 || buffer->getDimensions() != dims) {
+        buffer = std::make_shared<Image>(dims, DataVec4UInt8::get());
+    }
+    return buffer;
+}
+
+const LayerRAM* ImageSequenceMappingCPU::load(size_t frame) {
+    if (loadedFrame_ == frame) {
+        loadedFrame_ = noFrame;
+        return std::exchange(loadedLayer_, nullptr);
+    }
+    return frames_[frame]->getColorLayer()->getRepresentation<LayerRAM>();
+}
+
+void ImageSequenceMappingCPU::prefetch(size_t frame) {
+    loadedFrame_ = noFrame;
+    loadedLayer_ = nullptr;
+    if (frame >= frames_.size()) return;
+
+    loadedLayer_ = frames_[frame]->getColorLayer()->getRepresentation<LayerRAM>();
+    loadedFrame_ = frame;
+}
+
+void ImageSequenceMappingCPU::startMapping(size_t frame) {
+    mappedFrame_ = noFrame;
+    if (frame >= frames_.size()) return;
+
+    // Both the input and the editable output representation are fetched here, on the main
+    // thread, and the worker only touches pixels. std::async is used for the stage itself so
+    // that mapToRGBA can use the whole pool.
+    const LayerRAM* inLayer = load(frame);
+    auto buffer = getBuffer(frame, inLayer->getDimensions());
+    auto outRep = static_cast<LayerRAMPrecision<glm::u8vec4>*>(
+        buffer->getColorLayer()->getEditableRepresentation<LayerRAM>());
+    glm::u8vec4* outPixels = outRep->getDataTyped();
+
+    mappedFrame_ = frame;
+    mapping_ = std::async(std::launch::async, [inLayer, outPixels, map = map_]() {
+        ImageMappingCPU::mapToRGBA(*inLayer, outPixels, map);
+    });
+}
+
+void ImageSequenceMappingCPU::process() {
+    if (frames_.empty()) return;
+
+    map_.clearColors();
+    for (size_t i = 0; i < numColors_.get(); i++) {
+        map_.addBaseColors(colors_[i].get());
+    }
+
+    const size_t frame = std::min(frame_.get(), frames_.size() - 1);
+
+    // Frame N is normally already mapped (or being mapped) from the previous evaluation,
+    // otherwise, i.e. on the first frame or after a seek, it is mapped here.
+    if (mappedFrame_ != frame) {
+        if (mapping_.valid()) mapping_.wait();
+        startMapping(frame);
+    }
+    mapping_.get();
+    mappedFrame_ = noFrame;
+    outport_.setData(buffers_[frame % numBuffers]);
+
+    // Map frame N+1 in the background while frame N+2 is loaded here, then the network uses
+    // frame N
+    startMapping(frame + 1);
+    prefetch(frame + 2);
+}
+
+}  // namespace inviwo
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/ports/datainport.h>
+#include <inviwo/core/ports/imageport.h>
+#include <inviwo/core/datastructures/image/image.h>
+#include <inviwo/core/datastructures/image/layerram.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+
+#include <array>
+#include <future>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \class ImageSequenceMappingCPU
+ * \brief Colormaps the selected frame of an image sequence, pipelined over frames
+ * Three stages run concurrently while stepping forward through the sequence: frame N is published
+ * to the network, frame N+1 is mapped on a background thread and the input representation of
+ * frame N+2 is loaded. Each stage holds at most one frame, so at most two frames are in flight
+ * beyond the published one, and a step costs the slowest stage rather than the sum of all.
+ *
+ * Representations can only be converted safely on the main thread, so the load stage runs there,
+ * after the mapping of N+1 has been dispatched. The background stage only reads and writes
+ * pixels. Output images are reused only once nothing else holds them, an image set on the
+ * outport is never modified.
+ */
+class IVW_MODULE_TNM067LAB1_API ImageSequenceMappingCPU : public Processor {
+public:
+    ImageSequenceMappingCPU();
+    virtual ~ImageSequenceMappingCPU();
+
+    virtual void process() override;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+private:
+    static constexpr size_t numBuffers = 2;
+    static constexpr size_t noFrame = std::numeric_limits<size_t>::max();
+
+    std::shared_ptr<Image> getBuffer(size_t frame, size2_t dims);
+    const LayerRAM* load(size_t frame);
+    void prefetch(size_t frame);
+    void startMapping(size_t frame);
+    void resetPipeline();
+
+    DataInport<std::vector<std::shared_ptr<Image>>> inport_;
+    ImageOutport outport_;
+
+    IntSizeTProperty frame_;
+
+    IntSizeTProperty numColors_;
+    std::array<FloatVec4Property, 10> colors_;
+
+    std::vector<std::shared_ptr<Image>> frames_;
+    ScalarToColorMapping map_;
+    std::array<std::shared_ptr<Image>, numBuffers> buffers_;
+
+    // Load stage, the input representation of loadedFrame_
+    size_t loadedFrame_ = noFrame;
+    const LayerRAM* loadedLayer_ = nullptr;
+
+    // Map stage
+    size_t mappedFrame_ = noFrame;
+    std::future<void> mapping_;
+};
+
+}  // namespace inviwo
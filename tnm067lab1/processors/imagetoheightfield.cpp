@@ -2,6 +2,18 @@
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
 #include <inviwo/core/util/imageramutils.h>
 #include <inviwo/core/datastructures/image/layerram.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/util/glmutils.h>
+#include <inviwo/core/datastructures/buffer/bufferramprecision.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <modules/tnm067lab1/utils/heightfieldtin.h>
+#include <modules/tnm067lab1/utils/imagesampling.h>
+#include <modules/tnm067lab1/utils/parallelutils.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
 
 namespace inviwo {
 
@@ -19,7 +31,33 @@ ImageToHeightfield::ImageToHeightfield()
     : Processor()
     , imageInport_("imageInport", true)
     , meshOutport_("meshOutport")
+    , lodOutport_("lodOutport")
+    , instanceOutport_("instanceOutport")
+    , meshMode_("meshMode", "Mesh Mode",
+                {{"boxes", "Boxes", MeshMode::Boxes},
+                 {"grid", "Smooth Grid", MeshMode::Grid},
+                 {"chunkedLOD", "Chunked LOD", MeshMode::ChunkedLOD},
+                 {"adaptive", "Adaptive", MeshMode::Adaptive},
+                 {"instanced", "Instanced Boxes", MeshMode::Instanced}})
+    , resample_("resample", "Resample", false)
+    , resolution_("resolution", "Resolution", size2_t(256), size2_t(1), size2_t(4096))
+    , interpolationMethod_(
+          "interpolationMethod", "Interpolation Method",
+          {
+              {"piecewiseconstant", "Piecewise Constant (Nearest Neighbor)",
+               ImageUpsampler::IntepolationMethod::PiecewiseConstant},
+              {"bilinear", "Bilinear", ImageUpsampler::IntepolationMethod::Bilinear},
+              {"biquadratic", "Biquadratic", ImageUpsampler::IntepolationMethod::Biquadratic},
+              {"barycentric", "Barycentric", ImageUpsampler::IntepolationMethod::Barycentric},
+          })
     , heightScaleFactor_("heightScaleFactor", "Height Scale Factor", 1.0f, 0.001f, 2.0f, 0.001f)
+    , maxError_("maxError", "Max Relative Error", 0.01f, 0.0f, 1.0f, 0.0001f)
+    , achievedError_("achievedError", "Achieved Relative Error", 0.0f, 0.0f, 1.0f, 0.0001f)
+    , triangleCount_("triangleCount", "Triangle Count", 0, 0, std::numeric_limits<size_t>::max())
+    , cullHiddenFaces_("cullHiddenFaces", "Cull Hidden Faces", true)
+    , cropSideFaces_("cropSideFaces", "Crop Side Faces", false)
+    , greedyMeshing_("greedyMeshing", "Merge Equal Faces", false)
+    , tileSize_("tileSize", "LOD Tile Size", 64, 8, 1024)
     , numColors_("numColors", "Number of colors", 2, 1, 10)
     , colors_(
           {FloatVec4Property{"color1", "Color 1", util::ordinalColor(0.0f, 0.0f, 0.0f, 1.0f)},
@@ -35,7 +73,38 @@ ImageToHeightfield::ImageToHeightfield()
 
     addPort(imageInport_);
     addPort(meshOutport_);
+    addPort(lodOutport_);
+    addPort(instanceOutport_);
+    addProperty(meshMode_);
+    addProperty(resample_);
+    addProperty(resolution_);
+    addProperty(interpolationMethod_);
+    auto isResampling = [](const auto& p) { return p.get(); };
+    resolution_.visibilityDependsOn(resample_, isResampling);
+    interpolationMethod_.visibilityDependsOn(resample_, isResampling);
     addProperty(heightScaleFactor_);
+    addProperty(maxError_);
+    addProperty(achievedError_);
+    addProperty(triangleCount_);
+    // Outputs of the triangulation, changing them should not trigger a new evaluation
+    achievedError_.setReadOnly(true);
+    achievedError_.setInvalidationLevel(InvalidationLevel::Valid);
+    triangleCount_.setReadOnly(true);
+    triangleCount_.setInvalidationLevel(InvalidationLevel::Valid);
+    auto isAdaptiveMode = [](const auto& p) { return p.get() == MeshMode::Adaptive; };
+    maxError_.visibilityDependsOn(meshMode_, isAdaptiveMode);
+    achievedError_.visibilityDependsOn(meshMode_, isAdaptiveMode);
+    triangleCount_.visibilityDependsOn(meshMode_, isAdaptiveMode);
+    addProperty(cullHiddenFaces_);
+    addProperty(cropSideFaces_);
+    addProperty(greedyMeshing_);
+    auto isBoxMode = [](const auto& p) { return p.get() == MeshMode::Boxes; };
+    cullHiddenFaces_.visibilityDependsOn(meshMode_, isBoxMode);
+    cropSideFaces_.visibilityDependsOn(meshMode_, isBoxMode);
+    greedyMeshing_.visibilityDependsOn(meshMode_, isBoxMode);
+    addProperty(tileSize_);
+    tileSize_.visibilityDependsOn(
+        meshMode_, [](const auto& p) { return p.get() == MeshMode::ChunkedLOD; });
 
     addProperty(numColors_);
     for (auto& c : colors_) {
@@ -53,79 +122,124 @@ ImageToHeightfield::ImageToHeightfield()
 }
 
 namespace {
-using HFMesh = TypedMesh<buffertraits::PositionsBuffer, buffertraits::NormalBuffer,
-                         buffertraits::ColorsBuffer>;
 
-void addFace(std::vector<HFMesh::Vertex>& vertices, std::vector<unsigned int>& indices,
-             const vec3& c1, const vec3& c2, const vec3& c3, const vec3& c4, const vec3& normal,
-             const vec4& color) {
+// Samples the first component of image at outDims positions with the same interpolation kernels
+// and coordinate mapping as ImageUpsampler. Like ImageUpsampler the interpolation is done in the
+// precision of the input, only the result is converted to float. The mesh builders need random
+// access to neighbouring values, so the samples are stored as one float per output pixel.
+std::vector<float> resampleValues(const LayerRAM& image, size2_t outDims,
+                                  ImageUpsampler::IntepolationMethod method) {
+    const size2_t inDims = image.getDimensions();
+    std::vector<float> result(outDims.x * outDims.y);
+    image.dispatch<void>([&](const auto rep) {
+        using ValueType = util::PrecisionValueType<decltype(rep)>;
+        using Component = typename util::value_type<ValueType>::type;
+        const ValueType* pixels = rep->getDataTyped();
 
-    unsigned int startID = static_cast<unsigned int>(vertices.size());
-    vertices.emplace_back(c1, normal, color);
-    vertices.emplace_back(c2, normal, color);
-    vertices.emplace_back(c3, normal, color);
-    vertices.emplace_back(c4, normal, color);
+        // Multi channel images are first reduced to their first component, at input resolution
+        std::vector<Component> channel;
+        const Component* source = nullptr;
+        if constexpr (std::is_same<ValueType, Component>::value) {
+            source = pixels;
+        } else {
+            channel.resize(inDims.x * inDims.y);
+            for (size_t i = 0; i < channel.size(); ++i) {
+                channel[i] = util::glmcomp(pixels[i], 0);
+            }
+            source = channel.data();
+        }
 
-    indices.insert(indices.end(),
-                   {startID + 0, startID + 1, startID + 2, startID + 0, startID + 2, startID + 3});
+        util::forEachJobParallel(outDims.y, [&](size_t y) {
+            for (size_t x = 0; x < outDims.x; ++x) {
+                const dvec2 inCoords =
+                    ImageUpsampler::convertCoordinate(ivec2(x, y), inDims, outDims);
+                result[x + y * outDims.x] =
+                    static_cast<float>(TNM067::sample(method, source, inDims, inCoords));
+            }
+        });
+    });
+    return result;
 }
 
-std::shared_ptr<Mesh> buildMesh(const LayerRAM& image, const ScalarToColorMapping& map,
-                                float scaleFactor) {
-    const auto dims = image.getDimensions();
-
-    auto mesh = std::make_shared<HFMesh>();
-    auto& indices =
-        mesh->addIndexBuffer(DrawType::Triangles, ConnectivityType::None)->getDataContainer();
-
-    std::vector<HFMesh::Vertex> vertices;
-
-    const auto bufferSize = 24 * dims.x * dims.y;
-    indices.reserve(bufferSize);
-    vertices.reserve(bufferSize);
-
-    const vec2 cellSize = 1.0f / vec2(dims);
-    util::forEachPixel(image, [&](const size2_t& pos) {
-        const vec2 origin2D = vec2(pos) * cellSize;
-        const vec3 origin(origin2D.x, 0.0f, origin2D.y);
-
-        // TODO: sample image
-        const float imageValue = image.getAsDouble(pos);
-
-        // Use imageValue to set color
-        const vec4 color = map.sample(imageValue);
-
-        const float height = imageValue * scaleFactor;
-
-        // Box Corners
-        const auto zero = origin + vec3(0.0f, 0.0f, 0.0f);
-        const auto px = origin + vec3(cellSize.x, 0.0f, 0.0f);
-        const auto pz = origin + vec3(0.0f, 0.0f, cellSize.y);
-        const auto py = origin + vec3(0.0f, height, 0.0f);
-        const auto pxpy = origin + vec3(cellSize.x, height, 0.0f);
-        const auto pxpz = origin + vec3(cellSize.x, 0.0f, cellSize.y);
-        const auto pypz = origin + vec3(0.0f, height, cellSize.y);
-        const auto pxpypz = origin + vec3(cellSize.x, height, cellSize.y);
-
-        // Box Normals
-        constexpr auto down = vec3(0.0f, -1.0f, 0.0f);
-        constexpr auto up = vec3(0.0f, 1.0f, 0.0f);
-        constexpr auto left = vec3(-1.0f, 0.0f, 0.0f);
-        constexpr auto right = vec3(1.0f, 0.0f, 0.0f);
-        constexpr auto front = vec3(0.0f, 0.0f, -1.0f);
-        constexpr auto back = vec3(0.0f, 0.0f, 1.0f);
-
-        addFace(vertices, indices, zero, px, pxpz, pz, down, color);       // Bottom face
-        addFace(vertices, indices, py, pxpy, pxpypz, pypz, up, color);     // Top face
-        addFace(vertices, indices, zero, pz, pypz, py, left, color);       // Left face
-        addFace(vertices, indices, px, pxpz, pxpypz, pxpy, right, color);  // Right face
-        addFace(vertices, indices, zero, px, pxpy, py, front, color);      // Front face
-        addFace(vertices, indices, pz, pxpz, pxpypz, pypz, back, color);   // Back face
-    });
+// One shared vertex per pixel corner
+std::shared_ptr<Mesh> buildGridMesh(const std::vector<float>& values, size2_t dims,
+                                    const ScalarToColorMapping& map, float scaleFactor) {
+    const auto corners = heightfield::cornerValues(values, dims);
+    return heightfield::buildGrid(corners, dims + size2_t(1), vec2(0.0f), 1.0f / vec2(dims), map,
+                                  scaleFactor)
+        .toMesh();
+}
 
-    mesh->addVertices(vertices);
+// Buffers of the meshes built from MeshBuffers, in the order they are added
+constexpr size_t positionBuffer = 0;
+constexpr size_t normalBuffer = 1;
+constexpr size_t colorBuffer = 2;
+
+// A new mesh with the same buffers as mesh, the buffers themselves are shared and not copied
+std::shared_ptr<Mesh> shareBuffers(const Mesh& mesh) {
+    const auto info = mesh.getDefaultMeshInfo();
+    auto res = std::make_shared<Mesh>(info.dt, info.ct);
+    res->setModelMatrix(mesh.getModelMatrix());
+    res->setWorldMatrix(mesh.getWorldMatrix());
+    for (const auto& [bufferInfo, buffer] : mesh.getBuffers()) {
+        res->addBuffer(bufferInfo, buffer);
+    }
+    for (const auto& [meshInfo, indices] : mesh.getIndexBuffers()) {
+        res->addIndices(meshInfo, indices);
+    }
+    return res;
+}
+
+// Replaces a buffer of mesh by a copy of it, so that it can be edited without affecting other
+// meshes sharing the buffer
+void detachBuffer(Mesh& mesh, size_t buffer) {
+    const auto [info, shared] = mesh.getBuffers()[buffer];
+    mesh.replaceBuffer(buffer, info, std::shared_ptr<BufferBase>(shared->clone()));
+}
+
+template <typename T>
+std::vector<T>& editableBuffer(Mesh& mesh, size_t buffer) {
+    auto ram = mesh.getBuffer(buffer)->getEditableRepresentation<BufferRAM>();
+    return static_cast<BufferRAMPrecision<T>*>(ram)->getDataContainer();
+}
+
+template <typename T>
+const std::vector<T>& readBuffer(const Mesh& mesh, size_t buffer) {
+    auto ram = mesh.getBuffer(buffer)->getRepresentation<BufferRAM>();
+    return static_cast<const BufferRAMPrecision<T>*>(ram)->getDataContainer();
+}
+
+// Multiplies all heights of the mesh by ratio. Box normals do not depend on the height scale,
+// grid normals are rescaled. The edited buffers are detached first.
+void rescaleHeights(Mesh& mesh, bool smoothNormals, float ratio) {
+    detachBuffer(mesh, positionBuffer);
+    for (auto& p : editableBuffer<vec3>(mesh, positionBuffer)) {
+        p.y *= ratio;
+    }
+    if (smoothNormals) {
+        detachBuffer(mesh, normalBuffer);
+        for (auto& n : editableBuffer<vec3>(mesh, normalBuffer)) {
+            n = glm::normalize(vec3(n.x * ratio, n.y, n.z * ratio));
+        }
+    }
+}
 
-    return mesh;
+// Rewrites the colors from faceValues, four vertices per face, or from the vertex heights when
+// there are no face values. The color buffer is detached first.
+void recolor(Mesh& mesh, const std::vector<float>& faceValues, float scaleFactor,
+             const ScalarToColorMapping& map) {
+    detachBuffer(mesh, colorBuffer);
+    auto& colors = editableBuffer<vec4>(mesh, colorBuffer);
+    if (!faceValues.empty()) {
+        for (size_t i = 0; i < colors.size(); ++i) {
+            colors[i] = map.sample(faceValues[i / 4]);
+        }
+    } else {
+        const auto& positions = readBuffer<vec3>(mesh, positionBuffer);
+        for (size_t i = 0; i < colors.size(); ++i) {
+            colors[i] = map.sample(positions[i].y / scaleFactor);
+        }
+    }
 }
 
 }  // namespace
@@ -138,7 +252,78 @@ void ImageToHeightfield::process() {
         map.addBaseColors(colors_[i].get());
     }
 
-    const auto mesh = buildMesh(*layer, map, heightScaleFactor_);
+    const bool structureModified =
+        imageInport_.isChanged() || meshMode_.isModified() ||
+        cullHiddenFaces_.isModified() || cropSideFaces_.isModified() ||
+        greedyMeshing_.isModified() || resample_.isModified() ||
+        (resample_ && (resolution_.isModified() || interpolationMethod_.isModified()));
+    if (mesh_ && !structureModified) {
+        // The previous mesh has already been handed to the outport and may be in use downstream.
+        // The new mesh shares its buffers, only the buffers that are updated are copied.
+        mesh_ = shareBuffers(*mesh_);
+        if (heightScaleFactor_.isModified()) {
+            rescaleHeights(*mesh_, meshMode_ == MeshMode::Grid,
+                           heightScaleFactor_ / meshScaleFactor_);
+            meshScaleFactor_ = heightScaleFactor_;
+        }
+        if (numColors_.isModified() ||
+            std::any_of(colors_.begin(), colors_.end(),
+                        [](const auto& c) { return c.isModified(); })) {
+            recolor(*mesh_, faceValues_, meshScaleFactor_, map);
+        }
+        meshOutport_.setData(mesh_);
+        return;
+    }
+
+    mesh_.reset();
+    faceValues_.clear();
+    meshScaleFactor_ = heightScaleFactor_;
+
+    const size2_t dims = resample_ ? resolution_.get() : layer->getDimensions();
+    auto values = resample_ ? resampleValues(*layer, dims, interpolationMethod_.get())
+                            : heightfield::readValues(*layer);
+
+    std::shared_ptr<const Mesh> mesh;
+    switch (meshMode_.get()) {
+        case MeshMode::Grid:
+            mesh_ = buildGridMesh(values, dims, map, heightScaleFactor_);
+            mesh = mesh_;
+            break;
+        case MeshMode::ChunkedLOD: {
+            auto lod = std::make_shared<HeightfieldLOD>(
+                HeightfieldLOD::build(std::move(values), dims, tileSize_, map, heightScaleFactor_));
+            mesh = lod->getMesh(0);
+            lodOutport_.setData(lod);
+            break;
+        }
+        case MeshMode::Adaptive: {
+            auto tin = heightfield::buildTIN(values, dims, maxError_, map, heightScaleFactor_);
+            achievedError_.set(tin.maxError);
+            triangleCount_.set(tin.triangles);
+            mesh = std::move(tin.buffers).toMesh();
+            break;
+        }
+        case MeshMode::Instanced: {
+            auto instances = std::make_shared<HeightfieldInstances>(
+                HeightfieldInstances::build(values, dims, map, heightScaleFactor_));
+            mesh = HeightfieldInstances::createCube();
+            instanceOutport_.setData(instances);
+            break;
+        }
+        case MeshMode::Boxes:
+        default: {
+            auto buffers = greedyMeshing_
+                               ? heightfield::buildGreedyBoxes(values, dims, map,
+                                                               heightScaleFactor_,
+                                                               cullHiddenFaces_, cropSideFaces_)
+                               : heightfield::buildBoxes(values, dims, map, heightScaleFactor_,
+                                                         cullHiddenFaces_, cropSideFaces_);
+            faceValues_ = std::move(buffers.faceValues);
+            mesh_ = std::move(buffers).toMesh();
+            mesh = mesh_;
+            break;
+        }
+    }
 
     meshOutport_.setData(mesh);
 }
@@ -3,16 +3,34 @@
 #include <modules/tnm067lab1/tnm067lab1moduledefine.h>
 #include <inviwo/core/processors/processor.h>
 #include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/properties/boolproperty.h>
 #include <inviwo/core/ports/imageport.h>
 #include <inviwo/core/ports/meshport.h>
+#include <inviwo/core/ports/dataoutport.h>
 #include <modules/base/properties/gaussianproperty.h>
 #include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <modules/tnm067lab1/processors/imageupsampler.h>
+#include <modules/tnm067lab1/utils/heightfieldlod.h>
+#include <modules/tnm067lab1/utils/heightfieldinstances.h>
 #include <inviwo/core/datastructures/geometry/basicmesh.h>
 
 namespace inviwo {
 
 class IVW_MODULE_TNM067LAB1_API ImageToHeightfield : public Processor {
 public:
+    /**
+     * Boxes: one independent box per pixel.
+     * Grid: one shared vertex per pixel corner with smooth normals, about 20x less memory.
+     * ChunkedLOD: quadtree of grid tiles over a mip pyramid, output on the lod outport. The mesh
+     * outport gets the coarsest tile.
+     * Adaptive: error bounded triangulation, only refined where the surface deviates more than
+     * the max relative error, a fraction of the height range.
+     * Instanced: a single unit cube on the mesh outport and one instance per pixel on the
+     * instance outport, see HeightfieldInstances.
+     */
+    enum class MeshMode { Boxes, Grid, ChunkedLOD, Adaptive, Instanced };
+
     ImageToHeightfield();
     virtual ~ImageToHeightfield() = default;
 
@@ -24,11 +42,30 @@ public:
 private:
     ImageInport imageInport_;
     MeshOutport meshOutport_;
+    DataOutport<HeightfieldLOD> lodOutport_;
+    DataOutport<HeightfieldInstances> instanceOutport_;
+    OptionProperty<MeshMode> meshMode_;
+    BoolProperty resample_;
+    IntSize2Property resolution_;
+    OptionProperty<ImageUpsampler::IntepolationMethod> interpolationMethod_;
     FloatProperty heightScaleFactor_;
+    FloatProperty maxError_;
+    FloatProperty achievedError_;
+    IntSizeTProperty triangleCount_;
+    BoolProperty cullHiddenFaces_;
+    BoolProperty cropSideFaces_;
+    BoolProperty greedyMeshing_;
+    IntSizeTProperty tileSize_;
 
     IntSizeTProperty numColors_;
     std::array<FloatVec4Property, 10> colors_;
 
+    // Last box or grid mesh. When only the scale or the colors change, a mesh sharing its
+    // buffers, with copies of the positions and normals or of the colors, is output instead of
+    // rebuilding it from the image.
+    std::shared_ptr<Mesh> mesh_;
+    std::vector<float> faceValues_;
+    float meshScaleFactor_ = 1.0f;
 };
 
 }  // namespace inviwo
@@ -0,0 +1,102 @@
+#include <modules/tnm067lab1/processors/imageupsamplemappingcpu.h>
+#include <modules/tnm067lab1/utils/imagesampling.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <inviwo/core/util/logcentral.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/util/indexmapper.h>
+#include <inviwo/core/util/imageramutils.h>
+
+namespace inviwo {
+
+const ProcessorInfo ImageUpsampleMappingCPU::processorInfo_{
+    "org.inviwo.ImageUpsampleMappingCPU",  // Class identifier
+    "Image Upsample Mapping CPU",          // Display name
+    "TNM067",                              // Category
+    CodeState::Experimental,               // Code state
+    Tags::CPU,                             // Tags
+};
+const ProcessorInfo ImageUpsampleMappingCPU::getProcessorInfo() const { return processorInfo_; }
+
+ImageUpsampleMappingCPU::ImageUpsampleMappingCPU()
+    : Processor()
+    , inport_("inport", true)
+    , outport_("outport", true)
+    , interpolationMethod_(
+          "interpolationMethod", "Interpolation Method",
+          {
+              {"piecewiseconstant", "Piecewise Constant (Nearest Neighbor)",
+               ImageUpsampler::IntepolationMethod::PiecewiseConstant},
+              {"bilinear", "Bilinear", ImageUpsampler::IntepolationMethod::Bilinear},
+              {"biquadratic", "Biquadratic", ImageUpsampler::IntepolationMethod::Biquadratic},
+              {"barycentric", "Barycentric", ImageUpsampler::IntepolationMethod::Barycentric},
+          })
+    , numColors_("numColors", "Number of colors", 2, 1, 10)
+    , colors_({FloatVec4Property{"color1", "Color 1", vec4(0, 0, 0, 1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color2", "Color 2", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color3", "Color 3", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color4", "Color 4", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color5", "Color 5", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color6", "Color 6", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color7", "Color 7", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color8", "Color 8", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color9", "Color 9", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color10", "Color 10", vec4(1), vec4(0, 0, 0, 1), vec4(1)}}) {
+
+    addPort(inport_);
+    addPort(outport_);
+    addProperty(interpolationMethod_);
+
+    addProperty(numColors_);
+    for (auto& c : colors_) {
+        c.setSemantics(PropertySemantics::Color);
+        c.setCurrentStateAsDefault();
+        addProperty(c);
+    }
+
+    auto colorVisibility = [&]() {
+        for (size_t i = 0; i < 10; i++) {
+            colors_[i].setVisible(i < numColors_);
+        }
+    };
+
+    numColors_.onChange(colorVisibility);
+    colorVisibility();
+}
+
+void ImageUpsampleMappingCPU::process() {
+    auto inImg = inport_.getData();
+    if (inImg->getDataFormat()->getComponents() != 1) {
+        LogError("The ImageUpsampleMappingCPU processor does only support single channel images");
+    }
+
+    const size2_t outDim = outport_.getDimensions();
+    auto img = std::make_shared<Image>(outDim, DataVec4UInt8::get());
+    auto outRep = static_cast<LayerRAMPrecision<glm::u8vec4>*>(
+        img->getColorLayer()->getEditableRepresentation<LayerRAM>());
+    glm::u8vec4* outPixels = outRep->getDataTyped();
+    util::IndexMapper2D index(outDim);
+
+    ScalarToColorMapping map;
+    for (size_t i = 0; i < numColors_.get(); i++) {
+        map.addBaseColors(colors_[i].get());
+    }
+
+    const auto method = interpolationMethod_.get();
+    const auto inLayer = inImg->getColorLayer()->getRepresentation<LayerRAM>();
+    inLayer->dispatch<void, dispatching::filter::Scalars>([&](const auto inRep) {
+        const size2_t inDim = inRep->getDimensions();
+        const auto inPixels = inRep->getDataTyped();
+        util::forEachPixelParallel(*outRep, [&](size2_t pos) {
+            const dvec2 inCoords = ImageUpsampler::convertCoordinate(ivec2(pos), inDim, outDim);
+            // Interpolate in the input precision to give the same result as the
+            // ImageUpsampler -> ImageMappingCPU network
+            const auto value = TNM067::sample(method, inPixels, inDim, inCoords);
+            const float inPixelVal = util::glm_convert_normalized<float>(value);
+            outPixels[index(pos)] = map.sample(inPixelVal) * 255.f;
+        });
+    });
+
+    outport_.setData(img);
+}
+
+}  // namespace inviwo
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/ports/imageport.h>
+#include <modules/tnm067lab1/processors/imageupsampler.h>
+
+namespace inviwo {
+
+/**
+ * \class ImageUpsampleMappingCPU
+ * \brief Fused ImageUpsampler and ImageMappingCPU
+ * Evaluates the interpolation kernel and the color mapping per output pixel in a single parallel
+ * pass, without materializing the upsampled scalar image.
+ */
+class IVW_MODULE_TNM067LAB1_API ImageUpsampleMappingCPU : public Processor {
+public:
+    ImageUpsampleMappingCPU();
+    virtual ~ImageUpsampleMappingCPU() = default;
+
+    virtual void process() override;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+private:
+    ImageInport inport_;
+    ImageOutport outport_;
+
+    OptionProperty<ImageUpsampler::IntepolationMethod> interpolationMethod_;
+
+    IntSizeTProperty numColors_;
+    std::array<FloatVec4Property, 10> colors_;
+};
+
+}  // namespace inviwo
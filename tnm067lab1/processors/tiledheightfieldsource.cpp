@@ -0,0 +1,82 @@
+#include <modules/tnm067lab1/processors/tiledheightfieldsource.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+
+#include <cstdint>
+#include <limits>
+
+namespace inviwo {
+
+const ProcessorInfo TiledHeightfieldSource::processorInfo_{
+    "org.inviwo.TiledHeightfieldSource",  // Class identifier
+    "Tiled Heightfield Source",           // Display name
+    "TNM067",                             // Category
+    CodeState::Experimental,              // Code state
+    Tags::CPU,                            // Tags
+};
+const ProcessorInfo TiledHeightfieldSource::getProcessorInfo() const { return processorInfo_; }
+
+TiledHeightfieldSource::TiledHeightfieldSource()
+    : Processor()
+    , outport_("outport")
+    , file_("file", "Raw File")
+    , outputDirectory_("outputDirectory", "Output Directory")
+    , dimensions_("dimensions", "Dimensions", size2_t(1024), size2_t(1),
+                  size2_t(std::numeric_limits<std::uint32_t>::max()))
+    , format_("format", "Format",
+              {{"uint8", "UInt8", DataFormatId::UInt8},
+               {"uint16", "UInt16", DataFormatId::UInt16},
+               {"float32", "Float32", DataFormatId::Float32}})
+    , headerSize_("headerSize", "Header Size (bytes)", 0, 0, 4096)
+    , tileSize_("tileSize", "Tile Size", 256, 16, 4096)
+    , heightScaleFactor_("heightScaleFactor", "Height Scale Factor", 1.0f, 0.001f, 2.0f, 0.001f)
+    , numColors_("numColors", "Number of colors", 2, 1, 10)
+    , colors_({FloatVec4Property{"color1", "Color 1", vec4(0, 0, 0, 1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color2", "Color 2", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color3", "Color 3", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color4", "Color 4", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color5", "Color 5", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color6", "Color 6", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color7", "Color 7", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color8", "Color 8", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color9", "Color 9", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color10", "Color 10", vec4(1), vec4(0, 0, 0, 1), vec4(1)}}) {
+
+    addPort(outport_);
+    addProperty(file_);
+    addProperty(outputDirectory_);
+    addProperty(dimensions_);
+    addProperty(format_);
+    addProperty(headerSize_);
+    addProperty(tileSize_);
+    addProperty(heightScaleFactor_);
+
+    addProperty(numColors_);
+    for (auto& c : colors_) {
+        c.setSemantics(PropertySemantics::Color);
+        c.setCurrentStateAsDefault();
+        addProperty(c);
+    }
+
+    auto colorVisibility = [&]() {
+        for (size_t i = 0; i < 10; i++) {
+            colors_[i].setVisible(i < numColors_);
+        }
+    };
+
+    numColors_.onChange(colorVisibility);
+    colorVisibility();
+}
+
+void TiledHeightfieldSource::process() {
+    ScalarToColorMapping map;
+    for (size_t i = 0; i < numColors_.get(); i++) {
+        map.addBaseColors(colors_[i].get());
+    }
+
+    // Logs the reason and returns nullptr on failure
+    outport_.setData(HeightfieldTiles::build(file_.get(), dimensions_.get(), format_.get(),
+                                             headerSize_.get(), tileSize_.get(),
+                                             outputDirectory_.get(), map, heightScaleFactor_));
+}
+
+}  // namespace inviwo
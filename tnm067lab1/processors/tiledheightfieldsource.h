@@ -0,0 +1,50 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/heightfieldtiles.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/properties/fileproperty.h>
+#include <inviwo/core/properties/directoryproperty.h>
+#include <inviwo/core/ports/dataoutport.h>
+#include <inviwo/core/util/formats.h>
+
+#include <array>
+
+namespace inviwo {
+
+/**
+ * \class TiledHeightfieldSource
+ * \brief Smooth grid heightfield of a raw raster file, generated tile by tile
+ * Only one tile of the raster, plus a two pixel border, is read into memory per thread, so the
+ * raster may be larger than the available memory. Each tile mesh is written to the output
+ * directory in the raw mesh format as soon as it is built, and only the paths and bounding boxes
+ * of the tiles are output, see HeightfieldTiles::build.
+ */
+class IVW_MODULE_TNM067LAB1_API TiledHeightfieldSource : public Processor {
+public:
+    TiledHeightfieldSource();
+    virtual ~TiledHeightfieldSource() = default;
+
+    virtual void process() override;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+private:
+    DataOutport<HeightfieldTiles> outport_;
+
+    FileProperty file_;
+    DirectoryProperty outputDirectory_;
+    IntSize2Property dimensions_;
+    OptionProperty<DataFormatId> format_;
+    IntSizeTProperty headerSize_;
+    IntSizeTProperty tileSize_;
+    FloatProperty heightScaleFactor_;
+
+    IntSizeTProperty numColors_;
+    std::array<FloatVec4Property, 10> colors_;
+};
+
+}  // namespace inviwo
@@ -0,0 +1,141 @@
+#include <modules/tnm067lab1/processors/volumemappingcpu.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <modules/tnm067lab1/utils/parallelutils.h>
+#include <inviwo/core/datastructures/volume/volume.h>
+#include <inviwo/core/datastructures/volume/volumeramprecision.h>
+#include <inviwo/core/util/indexmapper.h>
+#include <inviwo/core/util/logcentral.h>
+
+#include <algorithm>
+
+namespace inviwo {
+
+const ProcessorInfo VolumeMappingCPU::processorInfo_{
+    "org.inviwo.VolumeMappingCPU",  // Class identifier
+    "Volume Mapping CPU",           // Display name
+    "TNM067",                       // Category
+    CodeState::Experimental,        // Code state
+    Tags::CPU,                      // Tags
+};
+const ProcessorInfo VolumeMappingCPU::getProcessorInfo() const { return processorInfo_; }
+
+VolumeMappingCPU::VolumeMappingCPU()
+    : Processor()
+    , inport_("inport")
+    , outport_("outport")
+    , brickSize_("brickSize", "Brick Size", 32, 8, 256)
+    , restrictZ_("restrictZ", "Restrict Z Range", false)
+    , zRange_("zRange", "Z Range", 0, 255, 0, 255)
+    , numColors_("numColors", "Number of colors", 2, 1, 10)
+    , colors_({FloatVec4Property{"color1", "Color 1", vec4(0, 0, 0, 1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color2", "Color 2", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color3", "Color 3", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color4", "Color 4", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color5", "Color 5", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color6", "Color 6", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color7", "Color 7", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color8", "Color 8", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color9", "Color 9", vec4(1), vec4(0, 0, 0, 1), vec4(1)},
+               FloatVec4Property{"color10", "Color 10", vec4(1), vec4(0, 0, 0, 1), vec4(1)}}) {
+
+    addPort(inport_);
+    addPort(outport_);
+
+    addProperty(brickSize_);
+    addProperty(restrictZ_);
+    addProperty(zRange_);
+    zRange_.visibilityDependsOn(restrictZ_, [](const auto& p) { return p.get(); });
+
+    inport_.onChange([this]() {
+        if (!inport_.hasData()) return;
+        const auto maxZ = static_cast<int>(inport_.getData()->getDimensions().z) - 1;
+        zRange_.setRangeMax(maxZ);
+    });
+
+    addProperty(numColors_);
+    for (auto& c : colors_) {
+        c.setSemantics(PropertySemantics::Color);
+        c.setCurrentStateAsDefault();
+        addProperty(c);
+    }
+
+    auto colorVisibility = [&]() {
+        for (size_t i = 0; i < 10; i++) {
+            colors_[i].setVisible(i < numColors_);
+        }
+    };
+
+    numColors_.onChange(colorVisibility);
+    colorVisibility();
+}
+
+void VolumeMappingCPU::process() {
+    auto inVol = inport_.getData();
+    if (inVol->getDataFormat()->getComponents() != 1) {
+        LogError("The VolumeMappingCPU processor does only support single channel volumes");
+        return;
+    }
+
+    const size3_t inDim = inVol->getDimensions();
+    size_t zBegin = 0;
+    size_t zEnd = inDim.z;
+    if (restrictZ_) {
+        zBegin = std::min(static_cast<size_t>(zRange_.getStart()), inDim.z - 1);
+        zEnd = std::clamp(static_cast<size_t>(zRange_.getEnd()) + 1, zBegin + 1, inDim.z);
+    }
+    const size3_t outDim(inDim.x, inDim.y, zEnd - zBegin);
+
+    // The output only covers the mapped slices, adjust the basis and offset to keep them in place
+    auto vol = std::make_shared<Volume>(outDim, DataVec4UInt8::get());
+    auto basis = inVol->getBasis();
+    auto offset = inVol->getOffset();
+    offset += basis[2] * (static_cast<float>(zBegin) / inDim.z);
+    basis[2] *= static_cast<float>(outDim.z) / inDim.z;
+    vol->setBasis(basis);
+    vol->setOffset(offset);
+    vol->setWorldMatrix(inVol->getWorldMatrix());
+
+    auto outRep = static_cast<VolumeRAMPrecision<glm::u8vec4>*>(
+        vol->getEditableRepresentation<VolumeRAM>());
+    glm::u8vec4* outVoxels = outRep->getDataTyped();
+
+    ScalarToColorMapping map;
+    for (size_t i = 0; i < numColors_.get(); i++) {
+        map.addBaseColors(colors_[i].get());
+    }
+
+    const dvec2 dataRange = inVol->dataMap_.dataRange;
+    const double invRange = dataRange.y > dataRange.x ? 1.0 / (dataRange.y - dataRange.x) : 0.0;
+
+    const size3_t brickSize(brickSize_.get());
+    const size3_t bricks = (outDim + brickSize - size3_t(1)) / brickSize;
+
+    inVol->getRepresentation<VolumeRAM>()->dispatch<void, dispatching::filter::Scalars>(
+        [&](const auto inRep) {
+            const auto inVoxels = inRep->getDataTyped();
+            const util::IndexMapper3D inIndex(inDim);
+            const util::IndexMapper3D outIndex(outDim);
+
+            util::forEachJobParallel(bricks.x * bricks.y * bricks.z, [&](size_t job) {
+                const size3_t brick(job % bricks.x, (job / bricks.x) % bricks.y,
+                                    job / (bricks.x * bricks.y));
+                const size3_t begin = brick * brickSize;
+                const size3_t end = glm::min(begin + brickSize, outDim);
+                for (size_t z = begin.z; z < end.z; ++z) {
+                    for (size_t y = begin.y; y < end.y; ++y) {
+                        size_t in = inIndex(begin.x, y, z + zBegin);
+                        size_t out = outIndex(begin.x, y, z);
+                        for (size_t x = begin.x; x < end.x; ++x, ++in, ++out) {
+                            const auto t = static_cast<float>(
+                                (static_cast<double>(inVoxels[in]) - dataRange.x) * invRange);
+                            outVoxels[out] = map.sample(t) * 255.f;
+                        }
+                    }
+                }
+            });
+        });
+
+    outport_.setData(vol);
+}
+
+}  // namespace inviwo
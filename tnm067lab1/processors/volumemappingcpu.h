@@ -0,0 +1,41 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/processors/processor.h>
+#include <inviwo/core/properties/boolproperty.h>
+#include <inviwo/core/properties/minmaxproperty.h>
+#include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/ports/volumeport.h>
+
+namespace inviwo {
+
+/**
+ * \class VolumeMappingCPU
+ * \brief Volume counterpart of ImageMappingCPU
+ * Maps a scalar volume to an RGBA8 volume using ScalarToColorMapping. Values are normalized using
+ * the data range of the input volume. The volume is processed in cubic bricks in parallel, and
+ * optionally only a range of z-slices is mapped.
+ */
+class IVW_MODULE_TNM067LAB1_API VolumeMappingCPU : public Processor {
+public:
+    VolumeMappingCPU();
+    virtual ~VolumeMappingCPU() = default;
+
+    virtual void process() override;
+
+    virtual const ProcessorInfo getProcessorInfo() const override;
+    static const ProcessorInfo processorInfo_;
+
+private:
+    VolumeInport inport_;
+    VolumeOutport outport_;
+
+    IntSizeTProperty brickSize_;
+    BoolProperty restrictZ_;
+    IntMinMaxProperty zRange_;
+
+    IntSizeTProperty numColors_;
+    std::array<FloatVec4Property, 10> colors_;
+};
+
+}  // namespace inviwo
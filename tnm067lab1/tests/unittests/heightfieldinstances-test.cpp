@@ -0,0 +1,55 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/heightfieldinstances.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <modules/tnm067lab1/utils/indexedimage.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <inviwo/core/datastructures/buffer/bufferram.h>
+#include <inviwo/core/datastructures/buffer/bufferramprecision.h>
+
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+const size2_t dims(3, 2);
+const std::vector<float> values{0.2f, 0.9f, -0.4f, 0.5f, 1.0f, 0.0f};
+
+}  // namespace
+
+TEST(HeightfieldInstancesTests, QuantizedInstances) {
+    static_assert(sizeof(HeightfieldInstances::Instance) == 4, "Instances should be 4 bytes");
+
+    const auto instances = HeightfieldInstances::build(values, dims, ScalarToColorMapping{}, 2.0f);
+    EXPECT_EQ(vec2(-0.8f, 2.0f), instances.getHeightRange());
+
+    const auto& data = instances.getInstances()->getRAMRepresentation()->getDataContainer();
+    ASSERT_EQ(values.size(), data.size());
+    const float step = 2.8f / 65535.0f;
+    for (size_t i = 0; i < values.size(); ++i) {
+        EXPECT_NEAR(values[i] * 2.0f, instances.height(data[i].x), step);
+        EXPECT_EQ(util::paletteIndex(values[i]), data[i].y);
+    }
+}
+
+TEST(HeightfieldInstancesTests, ExpandMatchesBoxes) {
+    const ScalarToColorMapping map;
+    const auto instances = HeightfieldInstances::build(values, dims, map, 2.0f);
+    const auto boxes = heightfield::buildBoxes(values, dims, map, 2.0f, false, false);
+
+    const auto mesh = instances.expand();
+    auto ram = mesh->getBuffer(0)->getRepresentation<BufferRAM>();
+    const auto& positions = static_cast<const BufferRAMPrecision<vec3>*>(ram)->getDataContainer();
+    ASSERT_EQ(boxes.positions.size(), positions.size());
+    for (size_t i = 0; i < positions.size(); ++i) {
+        EXPECT_NEAR(boxes.positions[i].x, positions[i].x, 1e-6f);
+        EXPECT_NEAR(boxes.positions[i].y, positions[i].y, 1e-4f);
+        EXPECT_NEAR(boxes.positions[i].z, positions[i].z, 1e-6f);
+    }
+}
+
+}  // namespace inviwo
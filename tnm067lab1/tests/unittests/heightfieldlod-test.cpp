@@ -0,0 +1,103 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/heightfieldlod.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <inviwo/core/datastructures/buffer/bufferram.h>
+#include <inviwo/core/datastructures/buffer/bufferramprecision.h>
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+const std::vector<vec3>& positions(const Mesh& mesh) {
+    auto ram = mesh.getBuffer(0)->getRepresentation<BufferRAM>();
+    return static_cast<const BufferRAMPrecision<vec3>*>(ram)->getDataContainer();
+}
+
+// Bounding box of the mesh positions
+std::pair<vec3, vec3> bounds(const Mesh& mesh) {
+    std::pair<vec3, vec3> res{vec3(std::numeric_limits<float>::max()),
+                              vec3(std::numeric_limits<float>::lowest())};
+    for (const auto& p : positions(mesh)) {
+        res.first = glm::min(res.first, p);
+        res.second = glm::max(res.second, p);
+    }
+    return res;
+}
+
+// Values in [-0.5, 1] on a 20 x 12 heightfield, four levels with 4 x 4 tiles
+const size2_t dims(20, 12);
+std::vector<float> testValues() {
+    std::vector<float> values(dims.x * dims.y);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = 0.1f * static_cast<float>((i * 5 + i / dims.x) % 16) - 0.5f;
+    }
+    return values;
+}
+
+}  // namespace
+
+TEST(HeightfieldLODTests, QuadtreeLevels) {
+    const auto lod = HeightfieldLOD::build(testValues(), dims, 4, ScalarToColorMapping{}, 2.0f);
+    ASSERT_EQ(4u, lod.getNumLevels());
+    const auto& nodes = lod.getNodes();
+    EXPECT_EQ(3u, nodes.front().level);
+
+    // One node per tile of each level, (5 x 3) + (3 x 2) + (2 x 1) + (1 x 1)
+    EXPECT_EQ(24u, nodes.size());
+    for (const auto& node : nodes) {
+        EXPECT_EQ(-1.0f, node.boundsMin.y);
+        for (const int child : node.children) {
+            if (child >= 0) EXPECT_EQ(node.level - 1, nodes[child].level);
+        }
+    }
+}
+
+TEST(HeightfieldLODTests, SelectionCoversUnitSquare) {
+    const auto lod = HeightfieldLOD::build(testValues(), dims, 4, ScalarToColorMapping{}, 2.0f);
+
+    EXPECT_EQ(1u, lod.select(vec3(0.5f, 100.0f, 0.5f), 0.1f).size());
+    EXPECT_EQ(15u, lod.select(vec3(0.5f, 0.0f, 0.5f), 100.0f).size());
+
+    for (const auto& viewPos : {vec3(0.0f, 1.0f, 0.0f), vec3(0.5f, 1.5f, 0.5f),
+                                vec3(1.0f, 2.0f, 0.2f)}) {
+        const auto selected = lod.select(viewPos, 0.2f);
+        EXPECT_LT(1u, selected.size());
+
+        // The tiles lie within the unit square and their areas add up to it without overlap
+        std::vector<std::pair<vec3, vec3>> tiles;
+        float area = 0.0f;
+        for (const auto& mesh : selected) {
+            const auto b = bounds(*mesh);
+            EXPECT_LE(0.0f, b.first.x);
+            EXPECT_LE(0.0f, b.first.z);
+            EXPECT_GE(1.0f, b.second.x);
+            EXPECT_GE(1.0f, b.second.z);
+            area += (b.second.x - b.first.x) * (b.second.z - b.first.z);
+            for (const auto& other : tiles) {
+                const vec3 overlap = glm::min(b.second, other.second) -
+                                     glm::max(b.first, other.first);
+                EXPECT_GE(1e-6f, std::max(0.0f, overlap.x) * std::max(0.0f, overlap.z));
+            }
+            tiles.push_back(b);
+        }
+        EXPECT_NEAR(1.0f, area, 1e-5f);
+    }
+}
+
+TEST(HeightfieldLODTests, SkirtsReachBase) {
+    const auto lod = HeightfieldLOD::build(testValues(), dims, 4, ScalarToColorMapping{}, 2.0f);
+    for (int id = 0; id < static_cast<int>(lod.getNodes().size()); ++id) {
+        const auto mesh = lod.getMesh(id);
+        EXPECT_EQ(-1.0f, bounds(*mesh).first.y);
+    }
+}
+
+}  // namespace inviwo
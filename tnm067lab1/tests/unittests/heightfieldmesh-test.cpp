@@ -0,0 +1,145 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+size_t numFaces(const heightfield::MeshBuffers& buffers) { return buffers.positions.size() / 4; }
+
+// Vertical extent of the faces with the given normal at x == planeX
+vec2 sideExtent(const heightfield::MeshBuffers& buffers, const vec3& normal, float planeX) {
+    vec2 extent(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+    for (size_t face = 0; face < numFaces(buffers); ++face) {
+        if (buffers.normals[4 * face] != normal || buffers.positions[4 * face].x != planeX) {
+            continue;
+        }
+        for (size_t v = 4 * face; v < 4 * face + 4; ++v) {
+            extent.x = std::min(extent.x, buffers.positions[v].y);
+            extent.y = std::max(extent.y, buffers.positions[v].y);
+        }
+    }
+    return extent;
+}
+
+// Total area of the faces with the given normal, all faces are rectangles
+float faceArea(const heightfield::MeshBuffers& buffers, const vec3& normal) {
+    float area = 0.0f;
+    for (size_t face = 0; face < numFaces(buffers); ++face) {
+        const auto v = buffers.positions.begin() + 4 * face;
+        if (buffers.normals[4 * face] == normal) {
+            area += glm::length(v[1] - v[0]) * glm::length(v[3] - v[0]);
+        }
+    }
+    return area;
+}
+
+const std::array<vec3, 6> boxNormals{vec3(0.0f, -1.0f, 0.0f), vec3(0.0f, 1.0f, 0.0f),
+                                     vec3(-1.0f, 0.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f),
+                                     vec3(0.0f, 0.0f, -1.0f), vec3(0.0f, 0.0f, 1.0f)};
+
+}  // namespace
+
+TEST(HeightfieldMeshTests, GridSharesCornerVertices) {
+    const ScalarToColorMapping map;
+    const size2_t dims(4, 3);
+    const std::vector<float> flat(dims.x * dims.y, 0.5f);
+    const auto corners = heightfield::cornerValues(flat, dims);
+    ASSERT_EQ((dims.x + 1) * (dims.y + 1), corners.size());
+
+    const auto grid = heightfield::buildGrid(corners, dims + size2_t(1), vec2(0.0f),
+                                             1.0f / vec2(dims), map, 2.0f);
+    EXPECT_EQ(corners.size(), grid.positions.size());
+    EXPECT_EQ(6 * dims.x * dims.y, grid.indices.size());
+    EXPECT_EQ(vec3(0.0f, 1.0f, 0.0f), grid.positions.front());
+    EXPECT_EQ(vec3(1.0f, 1.0f, 1.0f), grid.positions.back());
+    for (const auto& n : grid.normals) {
+        EXPECT_EQ(vec3(0.0f, 1.0f, 0.0f), n);
+    }
+    for (const auto i : grid.indices) {
+        EXPECT_LT(i, grid.positions.size());
+    }
+}
+
+TEST(HeightfieldMeshTests, BoxFaceCounts) {
+    const ScalarToColorMapping map;
+    const std::vector<float> values{1.0f};
+    EXPECT_EQ(6u, numFaces(heightfield::buildBoxes(values, size2_t(1), map, 1.0f, false, false)));
+    EXPECT_EQ(5u, numFaces(heightfield::buildBoxes(values, size2_t(1), map, 1.0f, true, false)));
+}
+
+TEST(HeightfieldMeshTests, CullingWithNegativeHeights) {
+    const ScalarToColorMapping map;
+    const vec3 left(-1.0f, 0.0f, 0.0f);
+    const vec3 right(1.0f, 0.0f, 0.0f);
+
+    // The right side of the first box is covered by the deeper second box
+    const std::vector<float> below{-1.0f, -2.0f};
+    const auto culled = heightfield::buildBoxes(below, size2_t(2, 1), map, 1.0f, true, false);
+    EXPECT_EQ(9u, numFaces(culled));
+    for (const auto& p : culled.positions) {
+        EXPECT_LE(-2.0f, p.y);
+        EXPECT_GE(0.0f, p.y);
+    }
+    EXPECT_EQ(vec2(-2.0f, 0.0f), sideExtent(culled, left, 0.5f));
+
+    const auto cropped = heightfield::buildBoxes(below, size2_t(2, 1), map, 1.0f, true, true);
+    EXPECT_EQ(9u, numFaces(cropped));
+    EXPECT_EQ(vec2(-2.0f, -1.0f), sideExtent(cropped, left, 0.5f));
+
+    // Same with positive heights
+    const std::vector<float> above{1.0f, 2.0f};
+    const auto positive = heightfield::buildBoxes(above, size2_t(2, 1), map, 1.0f, true, true);
+    EXPECT_EQ(9u, numFaces(positive));
+    EXPECT_EQ(vec2(1.0f, 2.0f), sideExtent(positive, left, 0.5f));
+
+    // Boxes on opposite sides of zero do not cover each other
+    const std::vector<float> mixed{1.0f, -1.0f};
+    const auto both = heightfield::buildBoxes(mixed, size2_t(2, 1), map, 1.0f, true, false);
+    EXPECT_EQ(10u, numFaces(both));
+    EXPECT_EQ(vec2(0.0f, 1.0f), sideExtent(both, right, 0.5f));
+    EXPECT_EQ(vec2(-1.0f, 0.0f), sideExtent(both, left, 0.5f));
+}
+
+TEST(HeightfieldMeshTests, GreedyCoversSameArea) {
+    const ScalarToColorMapping map;
+    const size2_t dims(7, 5);
+    std::vector<float> values(dims.x * dims.y);
+    for (size_t i = 0; i < values.size(); ++i) {
+        values[i] = 0.5f * static_cast<float>((i * 7 + i / 3) % 4) - 0.5f;
+    }
+
+    for (const bool cull : {false, true}) {
+        for (const bool crop : {false, true}) {
+            const auto boxes = heightfield::buildBoxes(values, dims, map, 2.0f, cull, crop);
+            const auto greedy = heightfield::buildGreedyBoxes(values, dims, map, 2.0f, cull, crop);
+            EXPECT_GT(numFaces(boxes), numFaces(greedy));
+            for (const auto& normal : boxNormals) {
+                EXPECT_NEAR(faceArea(boxes, normal), faceArea(greedy, normal), 1e-4f)
+                    << "cull " << cull << " crop " << crop << " normal " << normal;
+            }
+        }
+    }
+}
+
+TEST(HeightfieldMeshTests, GreedyMergesUniformImage) {
+    const ScalarToColorMapping map;
+    const std::vector<float> values(4 * 4, 1.0f);
+    EXPECT_EQ(5u, numFaces(heightfield::buildGreedyBoxes(values, size2_t(4), map, 1.0f, true,
+                                                         true)));
+    // Without culling the inner side faces remain, one run per row and column and direction
+    EXPECT_EQ(18u, numFaces(heightfield::buildGreedyBoxes(values, size2_t(4), map, 1.0f, false,
+                                                          false)));
+}
+
+}  // namespace inviwo
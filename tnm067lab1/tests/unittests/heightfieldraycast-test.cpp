@@ -0,0 +1,85 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/heightfieldraycast.h>
+
+#include <algorithm>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+const ivec2 dims(13, 9);
+std::vector<float> testHeights() {
+    std::vector<float> heights(dims.x * dims.y);
+    for (size_t i = 0; i < heights.size(); ++i) {
+        heights[i] = 0.05f * static_cast<float>((i * 7 + i / dims.x) % 11);
+    }
+    return heights;
+}
+
+}  // namespace
+
+TEST(HeightfieldRaycastTests, MaxMipmapLevels) {
+    const auto heights = testHeights();
+    const heightfield::MaxMipmap mipmap(heights, dims);
+    ASSERT_EQ(5u, mipmap.levels.size());
+    EXPECT_EQ(ivec2(7, 5), mipmap.levels[1].dims);
+    EXPECT_EQ(ivec2(1), mipmap.levels.back().dims);
+    EXPECT_EQ(*std::max_element(heights.begin(), heights.end()),
+              mipmap.levels.back().heights.front());
+
+    // Every cell is at least as high as the cells it covers on the previous level
+    for (size_t level = 1; level < mipmap.levels.size(); ++level) {
+        const auto& prev = mipmap.levels[level - 1];
+        for (int y = 0; y < prev.dims.y; ++y) {
+            for (int x = 0; x < prev.dims.x; ++x) {
+                EXPECT_LE(prev.at(ivec2(x, y)), mipmap.levels[level].at(ivec2(x, y) / 2));
+            }
+        }
+    }
+}
+
+TEST(HeightfieldRaycastTests, VerticalRaysHitTopFaces) {
+    const auto heights = testHeights();
+    const heightfield::MaxMipmap mipmap(heights, dims);
+    for (int y = 0; y < dims.y; ++y) {
+        for (int x = 0; x < dims.x; ++x) {
+            const vec2 center = (vec2(x, y) + 0.5f) / vec2(dims);
+            heightfield::RayHit hit;
+            ASSERT_TRUE(heightfield::castRay(mipmap, 0.0f, vec3(center.x, 2.0f, center.y),
+                                             vec3(0.0f, -1.0f, 0.0f), hit));
+            EXPECT_EQ(ivec2(x, y), hit.cell);
+            EXPECT_EQ(vec3(0.0f, 1.0f, 0.0f), hit.normal);
+        }
+    }
+}
+
+TEST(HeightfieldRaycastTests, SideFacesAndMisses) {
+    // A wall of height 1 at column 6, everything else is flat at zero
+    std::vector<float> heights(dims.x * dims.y, 0.0f);
+    for (int y = 0; y < dims.y; ++y) heights[6 + y * dims.x] = 1.0f;
+    const heightfield::MaxMipmap mipmap(heights, dims);
+
+    heightfield::RayHit hit;
+    ASSERT_TRUE(heightfield::castRay(mipmap, 0.0f, vec3(-1.0f, 0.5f, 0.3f),
+                                     vec3(1.0f, 0.0f, 0.0f), hit));
+    EXPECT_EQ(ivec2(6, static_cast<int>(0.3f * dims.y)), hit.cell);
+    EXPECT_EQ(vec3(-1.0f, 0.0f, 0.0f), hit.normal);
+
+    ASSERT_TRUE(heightfield::castRay(mipmap, 0.0f, vec3(2.0f, 0.5f, 0.7f),
+                                     vec3(-1.0f, 0.0f, 0.0f), hit));
+    EXPECT_EQ(ivec2(6, static_cast<int>(0.7f * dims.y)), hit.cell);
+    EXPECT_EQ(vec3(1.0f, 0.0f, 0.0f), hit.normal);
+
+    // Above the wall and beside the heightfield
+    EXPECT_FALSE(heightfield::castRay(mipmap, 0.0f, vec3(-1.0f, 1.5f, 0.5f),
+                                      vec3(1.0f, 0.0f, 0.0f), hit));
+    EXPECT_FALSE(heightfield::castRay(mipmap, 0.0f, vec3(-1.0f, 0.5f, 1.5f),
+                                      vec3(1.0f, 0.0f, 0.0f), hit));
+}
+
+}  // namespace inviwo
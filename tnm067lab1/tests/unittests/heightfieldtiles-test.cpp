@@ -0,0 +1,110 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/heightfieldtiles.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <modules/tnm067lab1/utils/meshio.h>
+#include <inviwo/core/datastructures/buffer/bufferram.h>
+#include <inviwo/core/datastructures/buffer/bufferramprecision.h>
+#include <inviwo/core/util/filesystem.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+template <typename T>
+const std::vector<T>& readBuffer(const Mesh& mesh, size_t buffer) {
+    auto ram = mesh.getBuffer(buffer)->getRepresentation<BufferRAM>();
+    return static_cast<const BufferRAMPrecision<T>*>(ram)->getDataContainer();
+}
+
+}  // namespace
+
+TEST(HeightfieldTilesTests, TilesMatchFullGrid) {
+    // A uint16 raster with a 16 byte header, not a multiple of the tile size
+    const size2_t dims(37, 21);
+    const size_t headerSize = 16;
+    std::vector<std::uint16_t> raster(dims.x * dims.y);
+    for (size_t y = 0; y < dims.y; ++y) {
+        for (size_t x = 0; x < dims.x; ++x) {
+            raster[x + y * dims.x] = static_cast<std::uint16_t>((x * 37 + y * 101) % 1000);
+        }
+    }
+    const auto directory = filesystem::getWorkingDirectory() + "/heightfieldtiles-test";
+    const auto rawPath = directory + ".raw";
+    {
+        std::ofstream file(rawPath, std::ios::binary);
+        const std::vector<char> header(headerSize, 0);
+        file.write(header.data(), header.size());
+        file.write(reinterpret_cast<const char*>(raster.data()),
+                   raster.size() * sizeof(std::uint16_t));
+    }
+
+    const ScalarToColorMapping map;
+    const float scaleFactor = 0.001f;
+    const auto index = HeightfieldTiles::build(rawPath, dims, DataFormatId::UInt16, headerSize,
+                                               16, directory, map, scaleFactor);
+    ASSERT_TRUE(index);
+    EXPECT_EQ(size2_t(3, 2), index->tileGrid);
+    ASSERT_EQ(6u, index->tiles.size());
+
+    // The whole raster as a single grid
+    const std::vector<float> values(raster.begin(), raster.end());
+    const auto full = heightfield::buildGrid(heightfield::cornerValues(values, dims),
+                                             dims + size2_t(1), vec2(0.0f), 1.0f / vec2(dims),
+                                             map, scaleFactor);
+
+    size_t numVertices = 0;
+    for (const auto& tile : index->tiles) {
+        const auto mesh = meshio::readRaw(tile.path);
+        ASSERT_TRUE(mesh);
+        const auto& positions = readBuffer<vec3>(*mesh, 0);
+        const auto& normals = readBuffer<vec3>(*mesh, 1);
+        numVertices += positions.size();
+
+        vec3 boundsMin(std::numeric_limits<float>::max());
+        vec3 boundsMax(std::numeric_limits<float>::lowest());
+        for (size_t i = 0; i < positions.size(); ++i) {
+            const auto& p = positions[i];
+            boundsMin = glm::min(boundsMin, p);
+            boundsMax = glm::max(boundsMax, p);
+
+            // Every tile vertex is the vertex of the same corner in the full grid
+            const auto cx = static_cast<size_t>(std::round(p.x * dims.x));
+            const auto cy = static_cast<size_t>(std::round(p.z * dims.y));
+            const size_t corner = cx + cy * (dims.x + 1);
+            EXPECT_NEAR(full.positions[corner].x, p.x, 1e-5f);
+            EXPECT_NEAR(full.positions[corner].y, p.y, 1e-5f);
+            EXPECT_NEAR(full.positions[corner].z, p.z, 1e-5f);
+            EXPECT_NEAR(0.0f, glm::distance(full.normals[corner], normals[i]), 1e-4f);
+        }
+        EXPECT_EQ(tile.boundsMin, boundsMin);
+        EXPECT_EQ(tile.boundsMax, boundsMax);
+        std::remove(tile.path.c_str());
+    }
+
+    // Neighbouring tiles both store their shared border, one extra corner column per tile column
+    // and one extra corner row per tile row
+    EXPECT_EQ((dims.x + 3) * (dims.y + 2), numVertices);
+
+    std::remove(rawPath.c_str());
+    std::remove(directory.c_str());
+}
+
+TEST(HeightfieldTilesTests, MissingRaster) {
+    const auto directory = filesystem::getWorkingDirectory() + "/heightfieldtiles-test";
+    EXPECT_FALSE(HeightfieldTiles::build(directory + "-missing.raw", size2_t(8),
+                                         DataFormatId::UInt8, 0, 4, directory,
+                                         ScalarToColorMapping{}, 1.0f));
+}
+
+}  // namespace inviwo
@@ -0,0 +1,77 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/heightfieldtin.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+
+#include <cmath>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+// Projected area of the triangles in the xz-plane
+float coveredArea(const heightfield::MeshBuffers& buffers) {
+    float area = 0.0f;
+    for (size_t i = 0; i < buffers.indices.size(); i += 3) {
+        const vec3 a = buffers.positions[buffers.indices[i]];
+        const vec3 b = buffers.positions[buffers.indices[i + 1]];
+        const vec3 c = buffers.positions[buffers.indices[i + 2]];
+        area += 0.5f * std::abs((b.x - a.x) * (c.z - a.z) - (b.z - a.z) * (c.x - a.x));
+    }
+    return area;
+}
+
+const size2_t dims(16, 16);
+std::vector<float> testValues() {
+    std::vector<float> values(dims.x * dims.y);
+    for (size_t y = 0; y < dims.y; ++y) {
+        for (size_t x = 0; x < dims.x; ++x) {
+            values[x + y * dims.x] = std::sin(0.4f * x) * std::cos(0.3f * y);
+        }
+    }
+    return values;
+}
+
+}  // namespace
+
+TEST(HeightfieldTINTests, FlatHeightfield) {
+    const std::vector<float> values(dims.x * dims.y, 0.5f);
+    const auto tin = heightfield::buildTIN(values, dims, 0.01f, ScalarToColorMapping{}, 1.0f);
+    EXPECT_EQ(2u, tin.triangles);
+    EXPECT_EQ(0.0f, tin.maxError);
+    EXPECT_NEAR(1.0f, coveredArea(tin.buffers), 1e-6f);
+}
+
+TEST(HeightfieldTINTests, CoverageAndErrorBound) {
+    const auto values = testValues();
+    const ScalarToColorMapping map;
+    size_t prevTriangles = 0;
+    for (const float maxError : {0.5f, 0.1f, 0.01f, 0.0f}) {
+        const auto tin = heightfield::buildTIN(values, dims, maxError, map, 1.0f);
+        EXPECT_EQ(3 * tin.triangles, tin.buffers.indices.size());
+        EXPECT_GE(2 * dims.x * dims.y, tin.triangles);
+        EXPECT_LE(prevTriangles, tin.triangles);
+        EXPECT_GE(maxError, tin.maxError);
+        EXPECT_NEAR(1.0f, coveredArea(tin.buffers), 1e-5f);
+        for (const auto& p : tin.buffers.positions) {
+            EXPECT_LE(0.0f, std::min(p.x, p.z));
+            EXPECT_GE(1.0f, std::max(p.x, p.z));
+        }
+        prevTriangles = tin.triangles;
+    }
+}
+
+TEST(HeightfieldTINTests, ErrorIsRelativeToHeightRange) {
+    const auto values = testValues();
+    const ScalarToColorMapping map;
+    const auto tin = heightfield::buildTIN(values, dims, 0.05f, map, 1.0f);
+    const auto scaled = heightfield::buildTIN(values, dims, 0.05f, map, 10.0f);
+    EXPECT_EQ(tin.triangles, scaled.triangles);
+    EXPECT_NEAR(tin.maxError, scaled.maxError, 1e-5f);
+}
+
+}  // namespace inviwo
@@ -0,0 +1,39 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/indexedimage.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+
+namespace inviwo {
+
+TEST(IndexedImageTests, PaletteIndexRange) {
+    EXPECT_EQ(0, util::paletteIndex(0.0f));
+    EXPECT_EQ(255, util::paletteIndex(1.0f));
+    EXPECT_EQ(0, util::paletteIndex(-1.0f));
+    EXPECT_EQ(255, util::paletteIndex(2.0f));
+    for (size_t i = 0; i < util::paletteSize; ++i) {
+        EXPECT_EQ(i, util::paletteIndex(static_cast<float>(i) / (util::paletteSize - 1)));
+    }
+}
+
+TEST(IndexedImageTests, PaletteSamplesMap) {
+    ScalarToColorMapping map;
+    map.addBaseColors(vec4(0.0f, 0.0f, 0.0f, 1.0f));
+    map.addBaseColors(vec4(1.0f, 1.0f, 1.0f, 1.0f));
+
+    const auto palette = util::createPalette(map);
+    ASSERT_EQ(util::paletteSize, palette.size());
+    for (size_t i = 0; i < palette.size(); ++i) {
+        const float t = static_cast<float>(i) / (util::paletteSize - 1);
+        EXPECT_NEAR(t, palette[i].r, 1e-6f);
+        EXPECT_FLOAT_EQ(1.0f, palette[i].a);
+    }
+    // Looking up the index of a value gives the closest palette color
+    for (const float t : {0.1f, 0.25f, 0.5f, 0.9f}) {
+        EXPECT_NEAR(t, palette[util::paletteIndex(t)].r, 0.5f / (util::paletteSize - 1));
+    }
+}
+
+}  // namespace inviwo
@@ -0,0 +1,135 @@
+#include <warn/push>
+#include <warn/ignore/all>
+#include <gtest/gtest.h>
+#include <warn/pop>
+
+#include <modules/tnm067lab1/utils/meshio.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <inviwo/core/datastructures/buffer/bufferram.h>
+#include <inviwo/core/datastructures/buffer/bufferramprecision.h>
+#include <inviwo/core/util/filesystem.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace inviwo {
+
+namespace {
+
+// A quad with a slanted normal and a non-uniform scale in x
+std::shared_ptr<Mesh> testMesh() {
+    heightfield::MeshBuffers buffers;
+    buffers.addFace(vec3(0.0f, 0.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f), vec3(1.0f, 1.0f, 0.0f),
+                    vec3(0.0f, 1.0f, 0.0f), glm::normalize(vec3(1.0f, 1.0f, 0.0f)),
+                    vec4(0.0f, 0.5f, 1.0f, 1.0f), 0.5f);
+    auto mesh = std::move(buffers).toMesh();
+    mat4 model(1.0f);
+    model[0][0] = 2.0f;
+    mesh->setModelMatrix(model);
+    return mesh;
+}
+
+template <typename T>
+const std::vector<T>& readBuffer(const Mesh& mesh, size_t buffer) {
+    auto ram = mesh.getBuffer(buffer)->getRepresentation<BufferRAM>();
+    return static_cast<const BufferRAMPrecision<T>*>(ram)->getDataContainer();
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& path, const std::string& contents) {
+    std::ofstream file(path, std::ios::binary);
+    file.write(contents.data(), contents.size());
+}
+
+}  // namespace
+
+TEST(MeshIOTests, RawRoundTrip) {
+    const auto path = filesystem::getWorkingDirectory() + "/meshio-test.raw";
+    const auto mesh = testMesh();
+    ASSERT_TRUE(meshio::writeRaw(*mesh, path));
+
+    const auto read = meshio::readRaw(path);
+    ASSERT_TRUE(read);
+    EXPECT_EQ(mesh->getModelMatrix(), read->getModelMatrix());
+    EXPECT_EQ(DrawType::Triangles, read->getDefaultMeshInfo().dt);
+    EXPECT_EQ(ConnectivityType::None, read->getDefaultMeshInfo().ct);
+
+    ASSERT_EQ(mesh->getNumberOfBuffers(), read->getNumberOfBuffers());
+    for (size_t i = 0; i < mesh->getNumberOfBuffers(); ++i) {
+        EXPECT_EQ(mesh->getBufferInfo(i).type, read->getBufferInfo(i).type);
+        EXPECT_EQ(mesh->getBufferInfo(i).location, read->getBufferInfo(i).location);
+        EXPECT_EQ(mesh->getBuffer(i)->getDataFormat(), read->getBuffer(i)->getDataFormat());
+    }
+    EXPECT_EQ(readBuffer<vec3>(*mesh, 0), readBuffer<vec3>(*read, 0));
+    EXPECT_EQ(readBuffer<vec3>(*mesh, 1), readBuffer<vec3>(*read, 1));
+    EXPECT_EQ(readBuffer<vec4>(*mesh, 2), readBuffer<vec4>(*read, 2));
+
+    ASSERT_EQ(1u, read->getNumberOfIndicies());
+    EXPECT_EQ(mesh->getIndices(0)->getRAMRepresentation()->getDataContainer(),
+              read->getIndices(0)->getRAMRepresentation()->getDataContainer());
+
+    std::remove(path.c_str());
+}
+
+TEST(MeshIOTests, RawRejectsInvalidFiles) {
+    const auto path = filesystem::getWorkingDirectory() + "/meshio-test.raw";
+    ASSERT_TRUE(meshio::writeRaw(*testMesh(), path));
+    const auto contents = readFile(path);
+
+    // Truncated data
+    writeFile(path, contents.substr(0, contents.size() - 8));
+    EXPECT_FALSE(meshio::readRaw(path));
+
+    // Wrong magic
+    auto corrupt = contents;
+    corrupt[0] = 'X';
+    writeFile(path, corrupt);
+    EXPECT_FALSE(meshio::readRaw(path));
+
+    // Unknown draw type, stored after the magic and the two buffer counts
+    corrupt = contents;
+    const std::uint32_t drawType = 1000;
+    std::memcpy(&corrupt[16], &drawType, sizeof(drawType));
+    writeFile(path, corrupt);
+    EXPECT_FALSE(meshio::readRaw(path));
+
+    EXPECT_FALSE(meshio::readRaw(path + ".missing"));
+    std::remove(path.c_str());
+}
+
+TEST(MeshIOTests, PLYTransformsNormals) {
+    const auto path = filesystem::getWorkingDirectory() + "/meshio-test.ply";
+    ASSERT_TRUE(meshio::writePLY(*testMesh(), path));
+    const auto contents = readFile(path);
+    std::remove(path.c_str());
+
+    EXPECT_NE(std::string::npos, contents.find("element vertex 4\n"));
+    EXPECT_NE(std::string::npos, contents.find("element face 2\n"));
+    const std::string endHeader = "end_header\n";
+    const auto dataBegin = contents.find(endHeader);
+    ASSERT_NE(std::string::npos, dataBegin);
+
+    // Position, normal and color of the second vertex
+    const size_t vertexSize = 6 * sizeof(float) + 4;
+    std::vector<float> vertex(6);
+    std::memcpy(vertex.data(), contents.data() + dataBegin + endHeader.size() + vertexSize,
+                vertex.size() * sizeof(float));
+    EXPECT_EQ(vec3(2.0f, 0.0f, 0.0f), vec3(vertex[0], vertex[1], vertex[2]));
+
+    // The inverse transpose halves the x component of the normal
+    const vec3 expected = glm::normalize(vec3(0.5f, 1.0f, 0.0f));
+    EXPECT_NEAR(expected.x, vertex[3], 1e-6f);
+    EXPECT_NEAR(expected.y, vertex[4], 1e-6f);
+    EXPECT_NEAR(expected.z, vertex[5], 1e-6f);
+}
+
+}  // namespace inviwo
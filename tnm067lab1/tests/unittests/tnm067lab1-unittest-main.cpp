@@ -7,15 +7,22 @@
 #include <gtest/gtest.h>
 #include <warn/pop>
 
+#include <inviwo/core/util/logcentral.h>
+
 #include <iostream>
 
 int main(int argc, char** argv) {
+    // Some of the tested functions log errors
+    inviwo::LogCentral::init();
+
     int ret = -1;
     {
         ::testing::InitGoogleTest(&argc, argv);
         ret = RUN_ALL_TESTS();
     }
 
+    inviwo::LogCentral::deleteInstance();
+
     std::cout << "Press any key to exit ..." << std::endl;
     std::cin.get();
 
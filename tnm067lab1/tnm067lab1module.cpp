@@ -2,6 +2,13 @@
 #include <modules/tnm067lab1/processors/imagetoheightfield.h>
 #include <modules/tnm067lab1/processors/imageupsampler.h>
 #include <modules/tnm067lab1/processors/imagemappingcpu.h>
+#include <modules/tnm067lab1/processors/imageupsamplemappingcpu.h>
+#include <modules/tnm067lab1/processors/volumemappingcpu.h>
+#include <modules/tnm067lab1/processors/imagesequencemappingcpu.h>
+#include <modules/tnm067lab1/processors/heightfieldraycastercpu.h>
+#include <modules/tnm067lab1/processors/tiledheightfieldsource.h>
+#include <modules/tnm067lab1/processors/binarymeshexport.h>
+#include <modules/tnm067lab1/processors/binarymeshsource.h>
 
 namespace inviwo {
 
@@ -14,6 +21,13 @@ TNM067Lab1Module::TNM067Lab1Module(InviwoApplication* app) : InviwoModule(app, "
     registerProcessor<ImageToHeightfield>();
     registerProcessor<ImageUpsampler>();
     registerProcessor<ImageMappingCPU>();
+    registerProcessor<ImageUpsampleMappingCPU>();
+    registerProcessor<VolumeMappingCPU>();
+    registerProcessor<ImageSequenceMappingCPU>();
+    registerProcessor<HeightfieldRaycasterCPU>();
+    registerProcessor<TiledHeightfieldSource>();
+    registerProcessor<BinaryMeshExport>();
+    registerProcessor<BinaryMeshSource>();
 }
 
 }  // namespace inviwo
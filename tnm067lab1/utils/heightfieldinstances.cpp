@@ -0,0 +1,102 @@
+#include <modules/tnm067lab1/utils/heightfieldinstances.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <modules/tnm067lab1/utils/indexedimage.h>
+#include <modules/tnm067lab1/utils/parallelutils.h>
+
+#include <array>
+#include <limits>
+
+namespace inviwo {
+
+const std::string HeightfieldInstances::classIdentifier = "org.inviwo.tnm067.HeightfieldInstances";
+const std::string HeightfieldInstances::dataName = "HeightfieldInstances";
+
+namespace {
+
+constexpr float maxQuantized = std::numeric_limits<std::uint16_t>::max();
+
+struct CubeFace {
+    std::array<vec3, 4> corners;
+    vec3 normal;
+};
+
+// Faces of the unit cube with the same corner order as the boxes of ImageToHeightfield
+const std::array<CubeFace, 6> cubeFaces = {{
+    {{{vec3(0, 0, 0), vec3(1, 0, 0), vec3(1, 0, 1), vec3(0, 0, 1)}}, vec3(0, -1, 0)},  // Bottom
+    {{{vec3(0, 1, 0), vec3(1, 1, 0), vec3(1, 1, 1), vec3(0, 1, 1)}}, vec3(0, 1, 0)},   // Top
+    {{{vec3(0, 0, 0), vec3(0, 0, 1), vec3(0, 1, 1), vec3(0, 1, 0)}}, vec3(-1, 0, 0)},  // Left
+    {{{vec3(1, 0, 0), vec3(1, 0, 1), vec3(1, 1, 1), vec3(1, 1, 0)}}, vec3(1, 0, 0)},   // Right
+    {{{vec3(0, 0, 0), vec3(1, 0, 0), vec3(1, 1, 0), vec3(0, 1, 0)}}, vec3(0, 0, -1)},  // Front
+    {{{vec3(0, 0, 1), vec3(1, 0, 1), vec3(1, 1, 1), vec3(0, 1, 1)}}, vec3(0, 0, 1)},   // Back
+}};
+
+}  // namespace
+
+HeightfieldInstances HeightfieldInstances::build(const std::vector<float>& values,
+                                                 size2_t dims, const ScalarToColorMapping& map,
+                                                 float scaleFactor) {
+    HeightfieldInstances result;
+    result.dims_ = dims;
+    result.palette_ = util::createPalette(map);
+    result.heightRange_ = heightfield::heightRange(values, scaleFactor);
+    if (result.heightRange_.y <= result.heightRange_.x) {
+        result.heightRange_.y = result.heightRange_.x + 1.0f;
+    }
+    const vec2 range = result.heightRange_;
+
+    std::vector<Instance> instances(dims.x * dims.y);
+    util::forEachJobParallel(dims.y, [&](size_t y) {
+        for (size_t x = 0; x < dims.x; ++x) {
+            const float value = values[x + y * dims.x];
+            const float t = (value * scaleFactor - range.x) / (range.y - range.x);
+            const auto quantized = static_cast<std::uint16_t>(t * maxQuantized + 0.5f);
+            instances[x + y * dims.x] = Instance(quantized, util::paletteIndex(value));
+        }
+    });
+    result.instances_ = util::makeBuffer(std::move(instances));
+
+    return result;
+}
+
+std::shared_ptr<Mesh> HeightfieldInstances::createCube() {
+    heightfield::MeshBuffers buffers;
+    for (const auto& face : cubeFaces) {
+        buffers.addFace(face.corners[0], face.corners[1], face.corners[2], face.corners[3],
+                        face.normal, vec4(1.0f), 0.0f);
+    }
+    return std::move(buffers).toMesh();
+}
+
+float HeightfieldInstances::height(std::uint16_t quantized) const {
+    return heightRange_.x + quantized / maxQuantized * (heightRange_.y - heightRange_.x);
+}
+
+std::shared_ptr<Mesh> HeightfieldInstances::expand() const {
+    const auto& instances = instances_->getRAMRepresentation()->getDataContainer();
+    const vec2 cellSize = getCellSize();
+
+    heightfield::MeshBuffers buffers;
+    buffers.resize(cubeFaces.size() * instances.size());
+
+    util::forEachJobParallel(dims_.y, [&](size_t y) {
+        for (size_t x = 0; x < dims_.x; ++x) {
+            const size_t i = x + y * dims_.x;
+            const auto& instance = instances[i];
+            const vec3 origin(x * cellSize.x, 0.0f, y * cellSize.y);
+            const vec3 scale(cellSize.x, height(instance.x), cellSize.y);
+            const vec4& color = palette_[instance.y];
+            const float value = instance.y / static_cast<float>(util::paletteSize - 1);
+
+            for (size_t f = 0; f < cubeFaces.size(); ++f) {
+                const auto& c = cubeFaces[f].corners;
+                buffers.setFace(cubeFaces.size() * i + f, origin + c[0] * scale,
+                                origin + c[1] * scale, origin + c[2] * scale,
+                                origin + c[3] * scale, cubeFaces[f].normal, color, value);
+            }
+        }
+    });
+
+    return std::move(buffers).toMesh();
+}
+
+}  // namespace inviwo
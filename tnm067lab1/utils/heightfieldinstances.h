@@ -0,0 +1,74 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <inviwo/core/datastructures/buffer/buffer.h>
+#include <inviwo/core/datastructures/geometry/mesh.h>
+#include <inviwo/core/util/glmvec.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \class HeightfieldInstances
+ * \brief Box heightfield as one instance per pixel, for instanced drawing of a single cube
+ * Each instance is 4 bytes: the quantized height and an index into the palette. The cell is not
+ * stored, instance i is the pixel (i % width, i / width), so that a shader gets it from
+ * gl_InstanceID and the width. Instance i is drawn as the unit cube of createCube() scaled by
+ * (cellSize.x, height, cellSize.y) and translated to (x * cellSize.x, 0, y * cellSize.y), which
+ * gives the same boxes as ImageToHeightfield's box mode. expand() builds those boxes explicitly
+ * on the CPU.
+ */
+class IVW_MODULE_TNM067LAB1_API HeightfieldInstances {
+public:
+    using Instance = glm::u16vec2;  // quantized height, palette index
+
+    /**
+     * Creates one instance per pixel of a heightfield of \p dims pixels with the values
+     * \p values. The palette samples \p map like util::createPalette.
+     */
+    static HeightfieldInstances build(const std::vector<float>& values, size2_t dims,
+                                      const ScalarToColorMapping& map, float scaleFactor);
+
+    /**
+     * The unit cube [0,1]^3 with face normals, drawn once per instance.
+     */
+    static std::shared_ptr<Mesh> createCube();
+
+    /**
+     * All boxes as explicit triangles, with the same layout as the box mode without culling.
+     */
+    std::shared_ptr<Mesh> expand() const;
+
+    const std::shared_ptr<Buffer<Instance>>& getInstances() const { return instances_; }
+    const std::vector<vec4>& getPalette() const { return palette_; }
+    size2_t getDimensions() const { return dims_; }
+    vec2 getCellSize() const { return 1.0f / vec2(dims_); }
+
+    /**
+     * Height of a quantized instance height.
+     */
+    float height(std::uint16_t quantized) const;
+
+    /**
+     * Heights are quantized linearly to [0, 65535] over this range, i.e. a quantized height q
+     * maps to range.x + q / 65535 * (range.y - range.x). Exposed so that a GPU consumer can
+     * dequantize the heights in a shader.
+     */
+    vec2 getHeightRange() const { return heightRange_; }
+
+    static const std::string classIdentifier;
+    static const std::string dataName;
+
+private:
+    std::shared_ptr<Buffer<Instance>> instances_;
+    std::vector<vec4> palette_;
+    size2_t dims_{0};
+    vec2 heightRange_{0.0f, 1.0f};
+};
+
+}  // namespace inviwo
@@ -0,0 +1,233 @@
+#include <modules/tnm067lab1/utils/heightfieldlod.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <modules/tnm067lab1/utils/parallelutils.h>
+#include <inviwo/core/util/indexmapper.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+namespace inviwo {
+
+const std::string HeightfieldLOD::classIdentifier = "org.inviwo.tnm067.HeightfieldLOD";
+const std::string HeightfieldLOD::dataName = "HeightfieldLOD";
+
+namespace {
+
+struct MipLevel {
+    std::vector<float> values;
+    size2_t dims;
+};
+
+// Each level is half the size of the previous one, each value the average of up to 2x2 values.
+// The values are moved into level 0.
+std::vector<MipLevel> buildMipLevels(std::vector<float> values, size2_t dims, size_t levels) {
+    std::vector<MipLevel> mips;
+    mips.reserve(levels);
+    mips.push_back({std::move(values), dims});
+    for (size_t level = 1; level < levels; ++level) {
+        const auto& prev = mips.back();
+        const size2_t mipDims = (prev.dims + size2_t(1)) / size2_t(2);
+        const util::IndexMapper2D prevIndex(prev.dims);
+
+        MipLevel mip{std::vector<float>(mipDims.x * mipDims.y), mipDims};
+        for (size_t y = 0; y < mipDims.y; ++y) {
+            for (size_t x = 0; x < mipDims.x; ++x) {
+                const size2_t begin(2 * x, 2 * y);
+                const size2_t end = glm::min(begin + size2_t(2), prev.dims);
+                float sum = 0.0f;
+                for (size_t j = begin.y; j < end.y; ++j) {
+                    for (size_t i = begin.x; i < end.x; ++i) {
+                        sum += prev.values[prevIndex(i, j)];
+                    }
+                }
+                mip.values[x + y * mipDims.x] = sum / ((end.x - begin.x) * (end.y - begin.y));
+            }
+        }
+        mips.push_back(std::move(mip));
+    }
+    return mips;
+}
+
+// Adds a skirt below the border of a grid of regionDims vertices, a strip of triangles from each
+// border vertex down to base. Adjacent tiles of different levels sample the heightfield at
+// different points along their shared border, the skirts fill the cracks between them.
+void addSkirts(heightfield::MeshBuffers& buffers, size2_t regionDims, float base) {
+    if (regionDims.x < 2 || regionDims.y < 2) return;
+
+    // Border vertices in order around the grid
+    std::vector<std::uint32_t> border;
+    const util::IndexMapper2D regionIndex(regionDims);
+    auto index = [&](size_t x, size_t y) { return static_cast<std::uint32_t>(regionIndex(x, y)); };
+    for (size_t x = 0; x + 1 < regionDims.x; ++x) border.push_back(index(x, 0));
+    for (size_t y = 0; y + 1 < regionDims.y; ++y) border.push_back(index(regionDims.x - 1, y));
+    for (size_t x = regionDims.x - 1; x > 0; --x) border.push_back(index(x, regionDims.y - 1));
+    for (size_t y = regionDims.y - 1; y > 0; --y) border.push_back(index(0, y));
+
+    const auto first = static_cast<std::uint32_t>(buffers.positions.size());
+    for (const auto i : border) {
+        const vec3 p = buffers.positions[i];
+        buffers.positions.emplace_back(p.x, std::min(base, p.y), p.z);
+        buffers.normals.push_back(buffers.normals[i]);
+        buffers.colors.push_back(buffers.colors[i]);
+    }
+
+    // Same winding as the grid
+    for (size_t i = 0; i < border.size(); ++i) {
+        const size_t next = (i + 1) % border.size();
+        const auto a = border[i];
+        const auto b = border[next];
+        const auto aBase = first + static_cast<std::uint32_t>(i);
+        const auto bBase = first + static_cast<std::uint32_t>(next);
+        buffers.indices.insert(buffers.indices.end(), {a, bBase, b, a, aBase, bBase});
+    }
+}
+
+}  // namespace
+
+HeightfieldLOD HeightfieldLOD::build(std::vector<float> values, size2_t dims,
+                                     size_t tileSize, const ScalarToColorMapping& map,
+                                     float scaleFactor, size_t cacheSize) {
+    const size_t maxDim = std::max(dims.x, dims.y);
+    size_t levels = 1;
+    while ((tileSize << (levels - 1)) < maxDim) ++levels;
+
+    HeightfieldLOD lod;
+    lod.dims_ = dims;
+    lod.tileSize_ = tileSize;
+    lod.map_ = map;
+    lod.scaleFactor_ = scaleFactor;
+    lod.cacheSize_ = cacheSize;
+    lod.cache_ = std::make_unique<TileCache>();
+
+    // Mip level values at the pixel corners, shared by all tiles of a level. The mip levels
+    // themselves are not needed once the corners are known.
+    {
+        const auto minIt = std::min_element(values.begin(), values.end());
+        lod.skirtBase_ = minIt != values.end() ? std::min(0.0f, *minIt * scaleFactor) : 0.0f;
+
+        const auto mips = buildMipLevels(std::move(values), dims, levels);
+        lod.corners_.resize(levels);
+        lod.cornerDims_.resize(levels);
+        util::forEachJobParallel(levels, [&](size_t level) {
+            lod.corners_[level] = heightfield::cornerValues(mips[level].values, mips[level].dims);
+            lod.cornerDims_[level] = mips[level].dims + size2_t(1);
+        });
+    }
+
+    // Creates the nodes of the tile and its descendants, returns -1 if the tile is outside of the
+    // heightfield
+    auto addNode = [&](auto& self, size_t level, size2_t tile) -> int {
+        const size2_t begin = tile * tileSize;
+        const size2_t mipDims = lod.cornerDims_[level] - size2_t(1);
+        if (begin.x >= mipDims.x || begin.y >= mipDims.y) return -1;
+
+        const int id = static_cast<int>(lod.nodes_.size());
+        lod.nodes_.push_back(Node{level, tile, vec3(0.0f), vec3(0.0f), {-1, -1, -1, -1}});
+        if (level > 0) {
+            for (size_t child = 0; child < 4; ++child) {
+                const size2_t childTile = 2 * tile + size2_t(child % 2, child / 2);
+                const int childId = self(self, level - 1, childTile);
+                lod.nodes_[id].children[child] = childId;
+            }
+        }
+        return id;
+    };
+    addNode(addNode, levels - 1, size2_t(0));
+
+    // Bounding boxes from the corner values, no meshes are built here
+    util::forEachJobParallel(lod.nodes_.size(), [&](size_t id) {
+        auto& node = lod.nodes_[id];
+        const auto& corners = lod.corners_[node.level];
+        const size2_t cornerDims = lod.cornerDims_[node.level];
+        const size2_t begin = node.tile * tileSize;
+        const size2_t end = glm::min(begin + size2_t(tileSize + 1), cornerDims);
+
+        float minValue = std::numeric_limits<float>::max();
+        float maxValue = std::numeric_limits<float>::lowest();
+        for (size_t y = begin.y; y < end.y; ++y) {
+            for (size_t x = begin.x; x < end.x; ++x) {
+                const float v = corners[x + y * cornerDims.x];
+                minValue = std::min(minValue, v);
+                maxValue = std::max(maxValue, v);
+            }
+        }
+
+        // Mip corner i lies at full resolution pixel i * 2^level, but never past the image
+        const size_t scale = size_t{1} << node.level;
+        const vec2 boundsBegin = vec2(glm::min(begin * scale, dims)) / vec2(dims);
+        const vec2 boundsEnd = vec2(glm::min((end - size2_t(1)) * scale, dims)) / vec2(dims);
+        // The skirts reach below the tile, down to the skirt base
+        node.boundsMin = vec3(boundsBegin.x, lod.skirtBase_, boundsBegin.y);
+        node.boundsMax = vec3(boundsEnd.x, std::max(0.0f, maxValue * scaleFactor), boundsEnd.y);
+    });
+
+    return lod;
+}
+
+std::shared_ptr<const Mesh> HeightfieldLOD::buildMesh(const Node& node) const {
+    const auto& corners = corners_[node.level];
+    const size2_t cornerDims = cornerDims_[node.level];
+    const size2_t begin = node.tile * tileSize_;
+    const size2_t end = glm::min(begin + size2_t(tileSize_ + 1), cornerDims);
+
+    // One mip pixel covers 2^level pixels of the full resolution heightfield, except the last one
+    // of a row or column when the size is not a multiple of 2^level. buildGrid clamps vertices to
+    // the unit square, which places the last corner exactly on the image border, and computes
+    // normals from the clamped positions.
+    const vec2 spacing = static_cast<float>(size_t{1} << node.level) / vec2(dims_);
+    auto buffers = heightfield::buildGrid(corners, cornerDims, begin, end, vec2(0.0f), spacing,
+                                          map_, scaleFactor_);
+    addSkirts(buffers, end - begin, skirtBase_);
+    return std::move(buffers).toMesh();
+}
+
+std::shared_ptr<const Mesh> HeightfieldLOD::getMesh(int id) const {
+    {
+        std::lock_guard<std::mutex> lock(cache_->mutex);
+        auto it = cache_->lookup.find(id);
+        if (it != cache_->lookup.end()) {
+            cache_->tiles.splice(cache_->tiles.begin(), cache_->tiles, it->second);
+            return it->second->second;
+        }
+    }
+
+    // Built without holding the lock so that several tiles can be built at the same time
+    auto mesh = buildMesh(nodes_[id]);
+
+    std::lock_guard<std::mutex> lock(cache_->mutex);
+    auto it = cache_->lookup.find(id);
+    if (it != cache_->lookup.end()) return it->second->second;
+    cache_->tiles.emplace_front(id, mesh);
+    cache_->lookup[id] = cache_->tiles.begin();
+    while (cache_->tiles.size() > cacheSize_) {
+        cache_->lookup.erase(cache_->tiles.back().first);
+        cache_->tiles.pop_back();
+    }
+    return mesh;
+}
+
+std::vector<std::shared_ptr<const Mesh>> HeightfieldLOD::select(const vec3& viewPos,
+                                                                float lodDistance) const {
+    std::vector<std::shared_ptr<const Mesh>> selected;
+    if (nodes_.empty()) return selected;
+
+    auto visit = [&](auto& self, int id) -> void {
+        const auto& node = nodes_[id];
+        const vec3 closest = glm::clamp(viewPos, node.boundsMin, node.boundsMax);
+        const float range = lodDistance * static_cast<float>(size_t{1} << node.level);
+        if (node.level == 0 || glm::distance(viewPos, closest) >= range) {
+            selected.push_back(getMesh(id));
+            return;
+        }
+        for (const int child : node.children) {
+            if (child >= 0) self(self, child);
+        }
+    };
+    visit(visit, 0);
+
+    return selected;
+}
+
+}  // namespace inviwo
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <inviwo/core/datastructures/geometry/mesh.h>
+#include <inviwo/core/util/glmvec.h>
+
+#include <array>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \class HeightfieldLOD
+ * \brief Chunked level of detail heightfield
+ * A quadtree of tiles where every tile has the same number of cells. A tile at level L samples
+ * the L:th mip level of the heightfield, level 0 is full resolution. Every node has a bounding
+ * box so that a renderer can choose tiles by view distance, see select().
+ *
+ * Only the mip levels and the tree are kept, tile meshes are built on demand by getMesh() and
+ * at most cacheSize of them are kept in a least recently used cache. Memory is thereby bounded
+ * by the mip levels, about 4/3 of the input values, plus the cache, rather than by a mesh of the
+ * whole pyramid.
+ *
+ * Each tile has a skirt, a vertical strip from its border down to the lowest point of the
+ * heightfield, or the ground plane, that hides the cracks between adjacent tiles of different
+ * levels.
+ *
+ * There is no renderer that consumes the quadtree yet, select() is the selection step such a
+ * renderer would call each frame.
+ */
+class IVW_MODULE_TNM067LAB1_API HeightfieldLOD {
+public:
+    struct Node {
+        size_t level;
+        size2_t tile;  // Tile index within the level
+        vec3 boundsMin;
+        vec3 boundsMax;
+        std::array<int, 4> children{-1, -1, -1, -1};  // -1 for tiles outside of the image
+    };
+
+    /**
+     * Builds the quadtree for a heightfield of \p dims pixels with the values \p values, using
+     * tiles of \p tileSize x \p tileSize cells. Meshes are laid out like ImageToHeightfield's
+     * grid mode, i.e. in the unit square of the xz-plane. The values are kept as level 0 of
+     * the mip pyramid, move them in if they are not needed afterwards.
+     */
+    static HeightfieldLOD build(std::vector<float> values, size2_t dims, size_t tileSize,
+                                const ScalarToColorMapping& map, float scaleFactor,
+                                size_t cacheSize = 256);
+
+    /**
+     * Selects the tiles to draw for a viewer at \p viewPos. A tile at level L is refined into its
+     * children while the distance to its bounding box is less than lodDistance * 2^L.
+     */
+    std::vector<std::shared_ptr<const Mesh>> select(const vec3& viewPos, float lodDistance) const;
+
+    /**
+     * The mesh of node \p id, built if it is not in the cache. Thread safe.
+     */
+    std::shared_ptr<const Mesh> getMesh(int id) const;
+
+    const std::vector<Node>& getNodes() const { return nodes_; }
+    size_t getNumLevels() const { return corners_.size(); }
+
+    static const std::string classIdentifier;
+    static const std::string dataName;
+
+private:
+    struct TileCache {
+        std::mutex mutex;
+        std::list<std::pair<int, std::shared_ptr<const Mesh>>> tiles;  // Most recent first
+        std::unordered_map<int, decltype(tiles)::iterator> lookup;
+    };
+
+    std::shared_ptr<const Mesh> buildMesh(const Node& node) const;
+
+    size2_t dims_{0};
+    size_t tileSize_ = 0;
+    ScalarToColorMapping map_;
+    float scaleFactor_ = 1.0f;
+    float skirtBase_ = 0.0f;
+
+    std::vector<Node> nodes_;                  // The root is the first node
+    std::vector<std::vector<float>> corners_;  // Corner values of each mip level
+    std::vector<size2_t> cornerDims_;
+
+    size_t cacheSize_ = 0;
+    std::unique_ptr<TileCache> cache_;
+};
+
+}  // namespace inviwo
@@ -0,0 +1,434 @@
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <inviwo/core/datastructures/buffer/buffer.h>
+#include <inviwo/core/util/indexmapper.h>
+#include <inviwo/core/util/imageramutils.h>
+#include <inviwo/core/util/glmutils.h>
+#include <inviwo/core/util/formatdispatching.h>
+#include <modules/tnm067lab1/utils/parallelutils.h>
+
+#include <algorithm>
+#include <numeric>
+
+namespace inviwo {
+
+namespace heightfield {
+
+void MeshBuffers::resize(size_t faces) {
+    positions.resize(4 * faces);
+    normals.resize(4 * faces);
+    colors.resize(4 * faces);
+    indices.resize(6 * faces);
+    faceValues.resize(faces);
+}
+
+void MeshBuffers::setFace(size_t face, const vec3& c1, const vec3& c2, const vec3& c3,
+                          const vec3& c4, const vec3& normal, const vec4& color,
+                          float value) {
+    const size_t v = 4 * face;
+    positions[v + 0] = c1;
+    positions[v + 1] = c2;
+    positions[v + 2] = c3;
+    positions[v + 3] = c4;
+    std::fill_n(normals.begin() + v, 4, normal);
+    std::fill_n(colors.begin() + v, 4, color);
+    faceValues[face] = value;
+
+    const auto startID = static_cast<std::uint32_t>(v);
+    const size_t i = 6 * face;
+    indices[i + 0] = startID + 0;
+    indices[i + 1] = startID + 1;
+    indices[i + 2] = startID + 2;
+    indices[i + 3] = startID + 0;
+    indices[i + 4] = startID + 2;
+    indices[i + 5] = startID + 3;
+}
+
+void MeshBuffers::addFace(const vec3& c1, const vec3& c2, const vec3& c3, const vec3& c4,
+                          const vec3& normal, const vec4& color, float value) {
+    const size_t face = positions.size() / 4;
+    resize(face + 1);
+    setFace(face, c1, c2, c3, c4, normal, color, value);
+}
+
+std::shared_ptr<Mesh> MeshBuffers::toMesh() && {
+    auto mesh = std::make_shared<Mesh>(DrawType::Triangles, ConnectivityType::None);
+    mesh->addBuffer(BufferType::PositionAttrib, util::makeBuffer(std::move(positions)));
+    mesh->addBuffer(BufferType::NormalAttrib, util::makeBuffer(std::move(normals)));
+    mesh->addBuffer(BufferType::ColorAttrib, util::makeBuffer(std::move(colors)));
+    mesh->addIndices(Mesh::MeshInfo(DrawType::Triangles, ConnectivityType::None),
+                     util::makeIndexBuffer(std::move(indices)));
+    return mesh;
+}
+
+std::vector<float> readValues(const LayerRAM& image) {
+    const auto dims = image.getDimensions();
+    std::vector<float> values(dims.x * dims.y);
+    image.dispatch<void>([&](const auto rep) {
+        using ValueType = util::PrecisionValueType<decltype(rep)>;
+        const ValueType* pixels = rep->getDataTyped();
+        util::forEachJobParallel(dims.y, [&](size_t y) {
+            const ValueType* row = pixels + y * dims.x;
+            float* out = values.data() + y * dims.x;
+            for (size_t x = 0; x < dims.x; ++x) {
+                out[x] = static_cast<float>(util::glmcomp(row[x], 0));
+            }
+        });
+    });
+    return values;
+}
+
+vec2 heightRange(const std::vector<float>& values, float scaleFactor) {
+    vec2 range(0.0f);
+    for (const auto value : values) {
+        range.x = std::min(range.x, value * scaleFactor);
+        range.y = std::max(range.y, value * scaleFactor);
+    }
+    return range;
+}
+
+std::vector<float> cornerValues(const std::vector<float>& values, size2_t dims) {
+    const size2_t corners = dims + size2_t(1);
+    const util::IndexMapper2D index(dims);
+    const util::IndexMapper2D cornerIndex(corners);
+
+    std::vector<float> result(corners.x * corners.y);
+    util::forEachPixel(corners, [&](const size2_t& corner) {
+        const size2_t begin = glm::max(corner, size2_t(1)) - size2_t(1);
+        const size2_t end = glm::min(corner + size2_t(1), dims);
+        double sum = 0.0;
+        for (size_t y = begin.y; y < end.y; ++y) {
+            for (size_t x = begin.x; x < end.x; ++x) {
+                sum += values[index(x, y)];
+            }
+        }
+        const auto count = (end.x - begin.x) * (end.y - begin.y);
+        result[cornerIndex(corner)] = static_cast<float>(sum / count);
+    });
+    return result;
+}
+
+MeshBuffers buildGrid(const std::vector<float>& values, size2_t dims, vec2 origin, vec2 spacing,
+                      const ScalarToColorMapping& map, float scaleFactor) {
+    return buildGrid(values, dims, size2_t(0), dims, origin, spacing, map, scaleFactor);
+}
+
+MeshBuffers buildGrid(const std::vector<float>& values, size2_t dims, size2_t begin, size2_t end,
+                      vec2 origin, vec2 spacing, const ScalarToColorMapping& map,
+                      float scaleFactor) {
+    const util::IndexMapper2D index(dims);
+    const size2_t regionDims = end - begin;
+    const util::IndexMapper2D regionIndex(regionDims);
+
+    MeshBuffers buffers;
+    buffers.positions.reserve(regionDims.x * regionDims.y);
+    buffers.normals.reserve(regionDims.x * regionDims.y);
+    buffers.colors.reserve(regionDims.x * regionDims.y);
+    buffers.indices.reserve(6 * (regionDims.x - 1) * (regionDims.y - 1));
+
+    auto place = [&](const size2_t& pos) {
+        return glm::min(origin + vec2(pos) * spacing, vec2(1.0f));
+    };
+
+    util::forEachPixel(regionDims, [&](const size2_t& regionPos) {
+        const size2_t pos = begin + regionPos;
+        const float value = values[index(pos)];
+        const vec2 pos2D = place(pos);
+
+        // Normal from central differences of the height, one-sided at the borders of values.
+        // Neighbours outside of the region are used, so adjacent regions get the same normals.
+        // Distances are taken between the clamped vertex positions, so a narrower last cell
+        // gets the correct slope.
+        const size2_t prev = glm::max(pos, size2_t(1)) - size2_t(1);
+        const size2_t next = glm::min(pos + size2_t(1), dims - size2_t(1));
+        const vec2 distance = place(next) - place(prev);
+        float dx = 0.0f;
+        float dz = 0.0f;
+        if (next.x != prev.x && distance.x > 0.0f) {
+            dx = (values[index(next.x, pos.y)] - values[index(prev.x, pos.y)]) * scaleFactor /
+                 distance.x;
+        }
+        if (next.y != prev.y && distance.y > 0.0f) {
+            dz = (values[index(pos.x, next.y)] - values[index(pos.x, prev.y)]) * scaleFactor /
+                 distance.y;
+        }
+
+        buffers.positions.emplace_back(pos2D.x, value * scaleFactor, pos2D.y);
+        buffers.normals.push_back(glm::normalize(vec3(-dx, 1.0f, -dz)));
+        buffers.colors.push_back(map.sample(value));
+    });
+
+    // Same winding as the top face of the boxes
+    util::forEachPixel(glm::max(regionDims, size2_t(1)) - size2_t(1), [&](const size2_t& pos) {
+        const auto i00 = static_cast<std::uint32_t>(regionIndex(pos));
+        const auto i10 = static_cast<std::uint32_t>(regionIndex(pos + size2_t(1, 0)));
+        const auto i11 = static_cast<std::uint32_t>(regionIndex(pos + size2_t(1, 1)));
+        const auto i01 = static_cast<std::uint32_t>(regionIndex(pos + size2_t(0, 1)));
+        buffers.indices.insert(buffers.indices.end(), {i00, i10, i11, i00, i11, i01});
+    });
+
+    return buffers;
+}
+
+namespace {
+
+// Box Normals
+constexpr auto down = vec3(0.0f, -1.0f, 0.0f);
+constexpr auto up = vec3(0.0f, 1.0f, 0.0f);
+constexpr auto left = vec3(-1.0f, 0.0f, 0.0f);
+constexpr auto right = vec3(1.0f, 0.0f, 0.0f);
+constexpr auto front = vec3(0.0f, 0.0f, -1.0f);
+constexpr auto back = vec3(0.0f, 0.0f, 1.0f);
+
+// The side faces of a cell of height h span [min(0, h), max(0, h)], heights may be negative.
+// A side face is hidden when the span of the neighbouring cell covers it. When cropping, side
+// faces only cover the part of the span that the neighbour does not, so hidden faces are always
+// dropped.
+bool isSideVisible(float height, float neighborHeight, bool cullHiddenFaces, bool cropSideFaces) {
+    if (!cullHiddenFaces && !cropSideFaces) return true;
+    const bool covered = std::min(0.0f, neighborHeight) <= std::min(0.0f, height) &&
+                         std::max(0.0f, neighborHeight) >= std::max(0.0f, height);
+    return !covered;
+}
+
+// The end of a visible side face opposite to the top of the cell. Both spans contain zero, so
+// the uncovered part of the span is a single interval from the height to the neighbour height
+// clamped to the span.
+float sideFaceBase(float height, float neighborHeight, bool cropSideFaces) {
+    if (!cropSideFaces) return 0.0f;
+    return glm::clamp(neighborHeight, std::min(0.0f, height), std::max(0.0f, height));
+}
+
+}  // namespace
+
+// The number of faces of each row is counted first, so that every row can be written in parallel
+// directly into the final, exactly sized, buffers.
+MeshBuffers buildBoxes(const std::vector<float>& values, size2_t dims,
+                       const ScalarToColorMapping& map, float scaleFactor, bool cullHiddenFaces,
+                       bool cropSideFaces) {
+    MeshBuffers buffers;
+    const util::IndexMapper2D index(dims);
+    const vec2 cellSize = 1.0f / vec2(dims);
+
+    // Height of a neighbouring cell, cells outside of the image have zero height
+    auto heightAt = [&](const size2_t& pos, const ivec2& offset) -> float {
+        const ivec2 p = ivec2(pos) + offset;
+        if (p.x < 0 || p.y < 0 || p.x >= static_cast<int>(dims.x) ||
+            p.y >= static_cast<int>(dims.y)) {
+            return 0.0f;
+        }
+        return values[index(size2_t(p))] * scaleFactor;
+    };
+
+    // Calls addFace(c1, c2, c3, c4, normal, color, value) for each face of the box at pos
+    auto forEachFace = [&](const size2_t& pos, auto addFace) {
+        const vec2 origin2D = vec2(pos) * cellSize;
+        const vec3 origin(origin2D.x, 0.0f, origin2D.y);
+
+        const float imageValue = values[index(pos)];
+
+        // Use imageValue to set color
+        const vec4 color = map.sample(imageValue);
+
+        const float height = imageValue * scaleFactor;
+
+        // Box Corners
+        const auto zero = origin + vec3(0.0f, 0.0f, 0.0f);
+        const auto px = origin + vec3(cellSize.x, 0.0f, 0.0f);
+        const auto pz = origin + vec3(0.0f, 0.0f, cellSize.y);
+        const auto py = origin + vec3(0.0f, height, 0.0f);
+        const auto pxpy = origin + vec3(cellSize.x, height, 0.0f);
+        const auto pxpz = origin + vec3(cellSize.x, 0.0f, cellSize.y);
+        const auto pypz = origin + vec3(0.0f, height, cellSize.y);
+        const auto pxpypz = origin + vec3(cellSize.x, height, cellSize.y);
+
+        auto showSide = [&](float neighborHeight) {
+            return isSideVisible(height, neighborHeight, cullHiddenFaces, cropSideFaces);
+        };
+        auto sideBase = [&](float neighborHeight) {
+            return vec3(0.0f, sideFaceBase(height, neighborHeight, cropSideFaces), 0.0f);
+        };
+        const float leftHeight = heightAt(pos, ivec2(-1, 0));
+        const float rightHeight = heightAt(pos, ivec2(1, 0));
+        const float frontHeight = heightAt(pos, ivec2(0, -1));
+        const float backHeight = heightAt(pos, ivec2(0, 1));
+
+        // Bottom faces are never visible from above
+        if (!cullHiddenFaces) {
+            addFace(zero, px, pxpz, pz, down, color, imageValue);  // Bottom face
+        }
+        addFace(py, pxpy, pxpypz, pypz, up, color, imageValue);  // Top face
+        if (showSide(leftHeight)) {
+            const auto base = sideBase(leftHeight);
+            addFace(zero + base, pz + base, pypz, py, left, color, imageValue);
+        }
+        if (showSide(rightHeight)) {
+            const auto base = sideBase(rightHeight);
+            addFace(px + base, pxpz + base, pxpypz, pxpy, right, color, imageValue);
+        }
+        if (showSide(frontHeight)) {
+            const auto base = sideBase(frontHeight);
+            addFace(zero + base, px + base, pxpy, py, front, color, imageValue);
+        }
+        if (showSide(backHeight)) {
+            const auto base = sideBase(backHeight);
+            addFace(pz + base, pxpz + base, pxpypz, pypz, back, color, imageValue);
+        }
+    };
+
+    // rowOffsets[y] is the index of the first face of row y
+    std::vector<size_t> rowOffsets(dims.y + 1, 0);
+    if (cullHiddenFaces || cropSideFaces) {
+        util::forEachJobParallel(dims.y, [&](size_t y) {
+            size_t faces = 0;
+            for (size_t x = 0; x < dims.x; ++x) {
+                forEachFace(size2_t(x, y), [&](auto&&...) { ++faces; });
+            }
+            rowOffsets[y + 1] = faces;
+        });
+        std::partial_sum(rowOffsets.begin(), rowOffsets.end(), rowOffsets.begin());
+    } else {
+        for (size_t y = 0; y <= dims.y; ++y) {
+            rowOffsets[y] = 6 * dims.x * y;
+        }
+    }
+
+    buffers.resize(rowOffsets.back());
+
+    util::forEachJobParallel(dims.y, [&](size_t y) {
+        size_t face = rowOffsets[y];
+        for (size_t x = 0; x < dims.x; ++x) {
+            forEachFace(size2_t(x, y), [&](const vec3& c1, const vec3& c2, const vec3& c3,
+                                           const vec3& c4, const vec3& normal, const vec4& color,
+                                           float value) {
+                buffers.setFace(face++, c1, c2, c3, c4, normal, color, value);
+            });
+        }
+    });
+
+    return buffers;
+}
+
+MeshBuffers buildGreedyBoxes(const std::vector<float>& values, size2_t dims,
+                             const ScalarToColorMapping& map, float scaleFactor,
+                             bool cullHiddenFaces, bool cropSideFaces) {
+    MeshBuffers buffers;
+    const util::IndexMapper2D index(dims);
+
+    const vec2 cellSize = 1.0f / vec2(dims);
+    auto corner = [&](size_t x, float y, size_t z) {
+        return vec3(x * cellSize.x, y, z * cellSize.y);
+    };
+
+    // Top and bottom faces
+    std::vector<bool> done(values.size(), false);
+    for (size_t y = 0; y < dims.y; ++y) {
+        for (size_t x = 0; x < dims.x; ++x) {
+            if (done[index(x, y)]) continue;
+
+            const float value = values[index(x, y)];
+            auto mergeable = [&](size_t i, size_t j) {
+                return !done[index(i, j)] && values[index(i, j)] == value;
+            };
+
+            size_t x1 = x + 1;
+            while (x1 < dims.x && mergeable(x1, y)) ++x1;
+            size_t y1 = y + 1;
+            for (; y1 < dims.y; ++y1) {
+                bool rowMergeable = true;
+                for (size_t i = x; i < x1 && rowMergeable; ++i) {
+                    rowMergeable = mergeable(i, y1);
+                }
+                if (!rowMergeable) break;
+            }
+            for (size_t j = y; j < y1; ++j) {
+                for (size_t i = x; i < x1; ++i) {
+                    done[index(i, j)] = true;
+                }
+            }
+
+            const float height = value * scaleFactor;
+            const vec4 color = map.sample(value);
+            buffers.addFace(corner(x, height, y), corner(x1, height, y), corner(x1, height, y1),
+                            corner(x, height, y1), up, color, value);
+            if (!cullHiddenFaces) {
+                buffers.addFace(corner(x, 0.0f, y), corner(x1, 0.0f, y), corner(x1, 0.0f, y1),
+                                corner(x, 0.0f, y1), down, color, value);
+            }
+        }
+    }
+
+    // Height of a neighbouring cell, cells outside of the image have zero height
+    auto heightAt = [&](const size2_t& pos, const ivec2& offset) -> float {
+        const ivec2 p = ivec2(pos) + offset;
+        if (p.x < 0 || p.y < 0 || p.x >= static_cast<int>(dims.x) ||
+            p.y >= static_cast<int>(dims.y)) {
+            return 0.0f;
+        }
+        return values[index(size2_t(p))] * scaleFactor;
+    };
+
+    // Side faces towards offset of the cells cell(0) ... cell(length - 1), merged into runs of
+    // equal value and base. emit(begin, end, base, height, value) adds the face of a run.
+    auto addSideRuns = [&](size_t length, auto cell, const ivec2& offset, auto emit) {
+        size_t begin = 0;
+        while (begin < length) {
+            const float value = values[index(cell(begin))];
+            const float height = value * scaleFactor;
+            const float neighborHeight = heightAt(cell(begin), offset);
+            if (!isSideVisible(height, neighborHeight, cullHiddenFaces, cropSideFaces)) {
+                ++begin;
+                continue;
+            }
+            const float base = sideFaceBase(height, neighborHeight, cropSideFaces);
+
+            size_t end = begin + 1;
+            for (; end < length; ++end) {
+                const float nextNeighborHeight = heightAt(cell(end), offset);
+                if (values[index(cell(end))] != value ||
+                    !isSideVisible(height, nextNeighborHeight, cullHiddenFaces, cropSideFaces) ||
+                    sideFaceBase(height, nextNeighborHeight, cropSideFaces) != base) {
+                    break;
+                }
+            }
+            emit(begin, end, base, height, value);
+            begin = end;
+        }
+    };
+
+    for (size_t x = 0; x < dims.x; ++x) {
+        auto cell = [x](size_t z) { return size2_t(x, z); };
+        addSideRuns(dims.y, cell, ivec2(-1, 0),
+                    [&](size_t z0, size_t z1, float base, float height, float value) {
+                        buffers.addFace(corner(x, base, z0), corner(x, base, z1),
+                                        corner(x, height, z1), corner(x, height, z0), left,
+                                        map.sample(value), value);
+                    });
+        addSideRuns(dims.y, cell, ivec2(1, 0),
+                    [&](size_t z0, size_t z1, float base, float height, float value) {
+                        buffers.addFace(corner(x + 1, base, z0), corner(x + 1, base, z1),
+                                        corner(x + 1, height, z1), corner(x + 1, height, z0),
+                                        right, map.sample(value), value);
+                    });
+    }
+    for (size_t z = 0; z < dims.y; ++z) {
+        auto cell = [z](size_t x) { return size2_t(x, z); };
+        addSideRuns(dims.x, cell, ivec2(0, -1),
+                    [&](size_t x0, size_t x1, float base, float height, float value) {
+                        buffers.addFace(corner(x0, base, z), corner(x1, base, z),
+                                        corner(x1, height, z), corner(x0, height, z), front,
+                                        map.sample(value), value);
+                    });
+        addSideRuns(dims.x, cell, ivec2(0, 1),
+                    [&](size_t x0, size_t x1, float base, float height, float value) {
+                        buffers.addFace(corner(x0, base, z + 1), corner(x1, base, z + 1),
+                                        corner(x1, height, z + 1), corner(x0, height, z + 1),
+                                        back, map.sample(value), value);
+                    });
+    }
+
+    return buffers;
+}
+
+}  // namespace heightfield
+
+}  // namespace inviwo
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <inviwo/core/datastructures/geometry/mesh.h>
+#include <inviwo/core/datastructures/image/layerram.h>
+#include <inviwo/core/util/glmvec.h>
+#include <inviwo/core/util/glmmat.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace inviwo {
+
+namespace heightfield {
+
+/**
+ * The image values as floats, in the same order as the pixels. Dispatches once on the format and
+ * reads the typed rows directly. Values are converted like LayerRAM::getAsDouble, i.e. the first
+ * component without normalization.
+ */
+IVW_MODULE_TNM067LAB1_API std::vector<float> readValues(const LayerRAM& image);
+
+/**
+ * \class MeshBuffers
+ * \brief Vertex and index data of a heightfield mesh
+ * Stored the way the mesh buffers store them so that builders can write into them directly and
+ * the containers can be moved into a Mesh without copying.
+ */
+struct IVW_MODULE_TNM067LAB1_API MeshBuffers {
+    std::vector<vec3> positions;
+    std::vector<vec3> normals;
+    std::vector<vec4> colors;
+    std::vector<std::uint32_t> indices;
+    std::vector<float> faceValues;  // Image value of each face, to recolor without a rebuild
+
+    /**
+     * Allocates space for exactly \p faces quads
+     */
+    void resize(size_t faces);
+
+    void setFace(size_t face, const vec3& c1, const vec3& c2, const vec3& c3, const vec3& c4,
+                 const vec3& normal, const vec4& color, float value);
+
+    void addFace(const vec3& c1, const vec3& c2, const vec3& c3, const vec3& c4,
+                 const vec3& normal, const vec4& color, float value);
+
+    std::shared_ptr<Mesh> toMesh() &&;
+};
+
+/**
+ * Vertical extent of a box or grid mesh of \p values, including the ground plane at zero
+ */
+IVW_MODULE_TNM067LAB1_API vec2 heightRange(const std::vector<float>& values, float scaleFactor);
+
+/**
+ * Value at each corner of a \p dims pixel grid, the average of the (up to four) pixels sharing
+ * the corner. The result has (dims.x + 1) * (dims.y + 1) values.
+ */
+IVW_MODULE_TNM067LAB1_API std::vector<float> cornerValues(const std::vector<float>& values,
+                                                          size2_t dims);
+
+/**
+ * Builds a regular grid with one vertex per value in \p values, laid out on a dims.x * dims.y
+ * grid. Vertex (i, j) is placed at origin + (i, j) * spacing in the xz-plane, clamped to the
+ * unit square, at height value * scaleFactor. Normals are computed from central differences.
+ */
+IVW_MODULE_TNM067LAB1_API MeshBuffers buildGrid(const std::vector<float>& values, size2_t dims,
+                                                vec2 origin, vec2 spacing,
+                                                const ScalarToColorMapping& map,
+                                                float scaleFactor);
+
+/**
+ * Builds the grid of the values in [\p begin, \p end) only. Vertex (i, j) of \p values is still
+ * placed at origin + (i, j) * spacing, and normals use the values around the region, so that
+ * adjacent regions share their border vertices exactly.
+ */
+IVW_MODULE_TNM067LAB1_API MeshBuffers buildGrid(const std::vector<float>& values, size2_t dims,
+                                                size2_t begin, size2_t end, vec2 origin,
+                                                vec2 spacing, const ScalarToColorMapping& map,
+                                                float scaleFactor);
+
+/**
+ * Builds one box per pixel of a heightfield of \p dims pixels with the values \p values, laid out
+ * in the unit square of the xz-plane. A box spans from zero to value * scaleFactor, heights may
+ * be negative. With \p cullHiddenFaces, bottom faces and side faces covered by the neighbouring
+ * box are dropped. With \p cropSideFaces, side faces only cover the part of the box that the
+ * neighbouring box does not.
+ */
+IVW_MODULE_TNM067LAB1_API MeshBuffers buildBoxes(const std::vector<float>& values, size2_t dims,
+                                                 const ScalarToColorMapping& map,
+                                                 float scaleFactor, bool cullHiddenFaces,
+                                                 bool cropSideFaces);
+
+/**
+ * Same boxes as buildBoxes, but coplanar faces of equal value, and thereby equal height and
+ * color, are merged. Top and bottom faces are merged into maximal rectangles, side faces into
+ * runs along each row or column of cells. The edges of a merged face span several edges of the
+ * unmerged neighbouring faces, these T-junctions can show up as single pixel cracks in the
+ * rasterization.
+ */
+IVW_MODULE_TNM067LAB1_API MeshBuffers buildGreedyBoxes(const std::vector<float>& values,
+                                                       size2_t dims,
+                                                       const ScalarToColorMapping& map,
+                                                       float scaleFactor, bool cullHiddenFaces,
+                                                       bool cropSideFaces);
+
+}  // namespace heightfield
+
+}  // namespace inviwo
@@ -0,0 +1,160 @@
+#include <modules/tnm067lab1/utils/heightfieldraycast.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace inviwo {
+
+namespace heightfield {
+
+MaxMipmap::MaxMipmap(std::vector<float> heights, ivec2 dims) {
+    levels.push_back({std::move(heights), dims});
+    while (levels.back().dims != ivec2(1)) {
+        const auto& prev = levels.back();
+        const ivec2 mipDims = (prev.dims + ivec2(1)) / 2;
+        Level mip{std::vector<float>(mipDims.x * mipDims.y), mipDims};
+        for (int y = 0; y < mipDims.y; ++y) {
+            for (int x = 0; x < mipDims.x; ++x) {
+                const ivec2 begin(2 * x, 2 * y);
+                const ivec2 end = glm::min(begin + ivec2(2), prev.dims);
+                float maxHeight = std::numeric_limits<float>::lowest();
+                for (int j = begin.y; j < end.y; ++j) {
+                    for (int i = begin.x; i < end.x; ++i) {
+                        maxHeight = std::max(maxHeight, prev.at(ivec2(i, j)));
+                    }
+                }
+                mip.heights[x + y * mipDims.x] = maxHeight;
+            }
+        }
+        levels.push_back(std::move(mip));
+    }
+}
+
+namespace {
+
+// Ray against the axis aligned box, returns false on a miss. axis is the axis of the entry face,
+// or -1 if the origin is inside.
+bool intersectBox(const vec3& o, const vec3& d, const vec3& lo, const vec3& hi, float& tNear,
+                  float& tFar, int& axis) {
+    tNear = 0.0f;
+    tFar = std::numeric_limits<float>::max();
+    axis = -1;
+    for (int i = 0; i < 3; ++i) {
+        if (d[i] == 0.0f) {
+            if (o[i] < lo[i] || o[i] > hi[i]) return false;
+            continue;
+        }
+        float t0 = (lo[i] - o[i]) / d[i];
+        float t1 = (hi[i] - o[i]) / d[i];
+        if (t0 > t1) std::swap(t0, t1);
+        if (t0 > tNear) {
+            tNear = t0;
+            axis = i;
+        }
+        tFar = std::min(tFar, t1);
+    }
+    return tNear <= tFar;
+}
+
+}  // namespace
+
+// Traverses the ray through the mipmap. On a skip the traversal moves up one level, otherwise it
+// moves down until a level 0 cell is hit. The current level 0 cell is tracked as integers and
+// stepped along the exit axis on every skip, the cell of a coarser level is derived from it by a
+// shift. Progress does thereby not depend on the floating point position of the ray, which
+// looses the sub cell precision for large heightfields.
+bool castRay(const MaxMipmap& mipmap, float baseHeight, const vec3& o, const vec3& d,
+             RayHit& hit) {
+    const auto& top = mipmap.levels.back();
+    const ivec2 dims = mipmap.levels.front().dims;
+    const int numLevels = static_cast<int>(mipmap.levels.size());
+
+    float t = 0.0f;
+    float tFar = 0.0f;
+    int axis = -1;
+    if (!intersectBox(o, d, vec3(0.0f, baseHeight, 0.0f), vec3(1.0f, top.heights.front(), 1.0f),
+                      t, tFar, axis)) {
+        return false;
+    }
+
+    // The ray in cell coordinates of level 0
+    const vec2 go = vec2(o.x, o.z) * vec2(dims);
+    const vec2 gd = vec2(d.x, d.z) * vec2(dims);
+    const ivec2 step(gd.x >= 0.0f ? 1 : -1, gd.y >= 0.0f ? 1 : -1);
+
+    ivec2 base = glm::clamp(ivec2(glm::floor(go + t * gd)), ivec2(0), dims - 1);
+
+    // Every skip moves base at least one cell forward along one axis, and between two skips the
+    // level can only go down numLevels times, which bounds the number of iterations. The limit
+    // guards against anything unforeseen rather than being expected to be reached.
+    const long long maxIterations =
+        (static_cast<long long>(dims.x) + dims.y + 2) * (2 * numLevels + 2);
+
+    int level = numLevels - 1;
+    for (long long iteration = 0; iteration < maxIterations; ++iteration) {
+        const auto& mip = mipmap.levels[level];
+        const int size = 1 << level;
+        const ivec2 cell = base >> level;
+
+        // Where the ray leaves the cell in the xz-plane
+        const ivec2 lo = cell * size;
+        const ivec2 hi = glm::min((cell + 1) * size, dims);
+        float tExit = tFar;
+        int exitAxis = -1;
+        if (gd.x != 0.0f) {
+            const float tx = (static_cast<float>(gd.x > 0.0f ? hi.x : lo.x) - go.x) / gd.x;
+            if (tx < tExit) {
+                tExit = tx;
+                exitAxis = 0;
+            }
+        }
+        if (gd.y != 0.0f) {
+            const float tz = (static_cast<float>(gd.y > 0.0f ? hi.y : lo.y) - go.y) / gd.y;
+            if (tz < tExit) {
+                tExit = tz;
+                exitAxis = 2;
+            }
+        }
+        tExit = std::max(tExit, t);
+
+        const float height = mip.at(cell);
+        const float yEnter = o.y + t * d.y;
+        const float yExit = o.y + tExit * d.y;
+        if (std::min(yEnter, yExit) > height) {
+            if (exitAxis < 0 || tExit >= tFar) return false;
+
+            // Step to the neighbouring level 0 cell across the exit face. The other coordinate is
+            // taken from the position but kept inside the exited cell.
+            const int i = exitAxis == 0 ? 0 : 1;
+            const int j = 1 - i;
+            ivec2 next;
+            next[i] = step[i] > 0 ? hi[i] : lo[i] - 1;
+            const float g = go[j] + tExit * gd[j];
+            next[j] = glm::clamp(static_cast<int>(std::floor(g)), lo[j], hi[j] - 1);
+            if (next[i] < 0 || next[i] >= dims[i]) return false;
+
+            base = next;
+            t = tExit;
+            axis = exitAxis;
+            level = std::min(level + 1, numLevels - 1);
+        } else if (level > 0) {
+            --level;
+        } else {
+            hit.cell = cell;
+            if (yEnter <= height && axis == 0) {
+                hit.normal = vec3(d.x > 0.0f ? -1.0f : 1.0f, 0.0f, 0.0f);
+            } else if (yEnter <= height && axis == 2) {
+                hit.normal = vec3(0.0f, 0.0f, d.z > 0.0f ? -1.0f : 1.0f);
+            } else {
+                hit.normal = vec3(0.0f, 1.0f, 0.0f);
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace heightfield
+
+}  // namespace inviwo
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/util/glmvec.h>
+
+#include <vector>
+
+namespace inviwo {
+
+namespace heightfield {
+
+/**
+ * \class MaxMipmap
+ * \brief Maximum mipmap of the heights of a box heightfield
+ * Level 0 holds the height of every cell, each following level the maximum of 2x2 cells of the
+ * previous one, down to a single cell.
+ */
+struct IVW_MODULE_TNM067LAB1_API MaxMipmap {
+    struct Level {
+        std::vector<float> heights;
+        ivec2 dims;
+        float at(const ivec2& cell) const { return heights[cell.x + cell.y * dims.x]; }
+    };
+    std::vector<Level> levels;
+
+    MaxMipmap() = default;
+    MaxMipmap(std::vector<float> heights, ivec2 dims);
+};
+
+struct IVW_MODULE_TNM067LAB1_API RayHit {
+    ivec2 cell;   // Level 0 cell that was hit
+    vec3 normal;  // Normal of the hit box face
+};
+
+/**
+ * Casts a ray with origin \p o and direction \p d against the boxes of \p mipmap, laid out in the
+ * unit square of the xz-plane and reaching down to \p baseHeight. Cells below the ray are
+ * skipped at the coarsest level possible. Returns false if no box is hit.
+ */
+IVW_MODULE_TNM067LAB1_API bool castRay(const MaxMipmap& mipmap, float baseHeight, const vec3& o,
+                                       const vec3& d, RayHit& hit);
+
+}  // namespace heightfield
+
+}  // namespace inviwo
@@ -0,0 +1,135 @@
+#include <modules/tnm067lab1/utils/heightfieldtiles.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <modules/tnm067lab1/utils/meshio.h>
+#include <modules/tnm067lab1/utils/parallelutils.h>
+#include <inviwo/core/util/filesystem.h>
+#include <inviwo/core/util/logcentral.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <limits>
+
+namespace inviwo {
+
+const std::string HeightfieldTiles::classIdentifier = "org.inviwo.tnm067.HeightfieldTiles";
+const std::string HeightfieldTiles::dataName = "HeightfieldTiles";
+
+namespace {
+
+// Reads the pixels [begin, end) of a dims raster of T stored row by row after headerSize bytes.
+// Values are not normalized, like LayerRAM::getAsDouble.
+template <typename T>
+bool readRegion(std::ifstream& file, size_t headerSize, size2_t dims, size2_t begin,
+                size2_t end, std::vector<float>& values) {
+    const size2_t regionDims = end - begin;
+    std::vector<T> row(regionDims.x);
+    values.resize(regionDims.x * regionDims.y);
+    for (size_t y = 0; y < regionDims.y; ++y) {
+        const size_t offset = headerSize + ((begin.y + y) * dims.x + begin.x) * sizeof(T);
+        file.seekg(static_cast<std::streamoff>(offset));
+        file.read(reinterpret_cast<char*>(row.data()),
+                  static_cast<std::streamsize>(row.size() * sizeof(T)));
+        if (!file) return false;
+        std::copy(row.begin(), row.end(), values.begin() + y * regionDims.x);
+    }
+    return true;
+}
+
+}  // namespace
+
+std::shared_ptr<HeightfieldTiles> HeightfieldTiles::build(
+    const std::string& path, size2_t dims, DataFormatId format, size_t headerSize,
+    size_t tileSize, const std::string& directory, const ScalarToColorMapping& map,
+    float scaleFactor) {
+
+    const size_t expectedSize =
+        headerSize + dims.x * dims.y * DataFormatBase::get(format)->getSize();
+    std::ifstream check(path, std::ios::binary | std::ios::ate);
+    if (!check || static_cast<size_t>(check.tellg()) < expectedSize) {
+        LogErrorCustom("HeightfieldTiles", "The raw file " << path
+                                                           << " is missing or smaller than "
+                                                           << expectedSize << " bytes");
+        return nullptr;
+    }
+    if (directory.empty()) {
+        LogErrorCustom("HeightfieldTiles", "No output directory for the tiles");
+        return nullptr;
+    }
+    filesystem::createDirectoryRecursively(directory);
+
+    const size2_t tiles = (dims + size2_t(tileSize - 1)) / tileSize;
+    const vec2 spacing = 1.0f / vec2(dims);
+
+    auto index = std::make_shared<HeightfieldTiles>();
+    index->tileGrid = tiles;
+    index->tiles.resize(tiles.x * tiles.y);
+    std::atomic<bool> readFailed{false};
+    std::atomic<bool> writeFailed{false};
+    util::forEachJobParallel(index->tiles.size(), [&](size_t tile) {
+        // The tile plus a border of two pixels, enough for the corner values and normals of the
+        // tile border to match the ones of the neighbouring tiles
+        const size2_t tileBegin = size2_t(tile % tiles.x, tile / tiles.x) * tileSize;
+        const size2_t tileEnd = glm::min(tileBegin + size2_t(tileSize), dims);
+        const size2_t regionBegin = glm::max(tileBegin, size2_t(2)) - size2_t(2);
+        const size2_t regionEnd = glm::min(tileEnd + size2_t(2), dims);
+        const size2_t regionDims = regionEnd - regionBegin;
+
+        std::ifstream file(path, std::ios::binary);
+        std::vector<float> values;
+        bool ok = false;
+        switch (format) {
+            case DataFormatId::UInt8:
+                ok = readRegion<std::uint8_t>(file, headerSize, dims, regionBegin, regionEnd,
+                                              values);
+                break;
+            case DataFormatId::UInt16:
+                ok = readRegion<std::uint16_t>(file, headerSize, dims, regionBegin, regionEnd,
+                                               values);
+                break;
+            case DataFormatId::Float32:
+            default:
+                ok = readRegion<float>(file, headerSize, dims, regionBegin, regionEnd, values);
+                break;
+        }
+        if (!ok) {
+            readFailed = true;
+            return;
+        }
+
+        // Corner (i, j) of the region is corner regionBegin + (i, j) of the raster
+        const auto corners = heightfield::cornerValues(values, regionDims);
+        auto buffers = heightfield::buildGrid(corners, regionDims + size2_t(1),
+                                              tileBegin - regionBegin,
+                                              tileEnd - regionBegin + size2_t(1),
+                                              vec2(regionBegin) * spacing, spacing, map,
+                                              scaleFactor);
+
+        auto& entry = index->tiles[tile];
+        entry.boundsMin = vec3(std::numeric_limits<float>::max());
+        entry.boundsMax = vec3(std::numeric_limits<float>::lowest());
+        for (const auto& p : buffers.positions) {
+            entry.boundsMin = glm::min(entry.boundsMin, p);
+            entry.boundsMax = glm::max(entry.boundsMax, p);
+        }
+
+        entry.path = directory + "/tile_" + std::to_string(tile % tiles.x) + "_" +
+                     std::to_string(tile / tiles.x) + ".raw";
+        if (!meshio::writeRaw(*std::move(buffers).toMesh(), entry.path)) {
+            writeFailed = true;
+        }
+    });
+
+    if (readFailed) {
+        LogErrorCustom("HeightfieldTiles", "Failed to read the raw file " << path);
+        return nullptr;
+    }
+    if (writeFailed) {
+        LogErrorCustom("HeightfieldTiles", "Failed to write the tiles to " << directory);
+        return nullptr;
+    }
+    return index;
+}
+
+}  // namespace inviwo
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+#include <inviwo/core/util/formats.h>
+#include <inviwo/core/util/glmvec.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace inviwo {
+
+/**
+ * \class HeightfieldTiles
+ * \brief Index of heightfield tiles stored on disk
+ * Each tile is a mesh in the raw mesh format, see meshio::readRaw, together with its bounding
+ * box so that a consumer can decide which tiles to load without reading them.
+ */
+class IVW_MODULE_TNM067LAB1_API HeightfieldTiles {
+public:
+    struct Tile {
+        std::string path;
+        vec3 boundsMin;
+        vec3 boundsMax;
+    };
+
+    /**
+     * Builds the smooth grid heightfield of the raw raster file \p path, \p dims pixels of
+     * \p format stored row by row after \p headerSize bytes, in tiles of \p tileSize pixels.
+     * Only one tile of the raster, plus a two pixel border, is read into memory per thread. Each
+     * tile mesh is laid out like ImageToHeightfield's grid mode and written to \p directory as
+     * tile_<x>_<y>.raw as soon as it is built. Neighbouring tiles share their border vertices
+     * exactly, normals included. Returns nullptr if the raster can not be read or a tile can not
+     * be written.
+     */
+    static std::shared_ptr<HeightfieldTiles> build(const std::string& path, size2_t dims,
+                                                   DataFormatId format, size_t headerSize,
+                                                   size_t tileSize, const std::string& directory,
+                                                   const ScalarToColorMapping& map,
+                                                   float scaleFactor);
+
+    size2_t tileGrid{0};      // Number of tiles in x and y
+    std::vector<Tile> tiles;  // Row by row, tile (x, y) is tiles[x + y * tileGrid.x]
+
+    static const std::string classIdentifier;
+    static const std::string dataName;
+};
+
+}  // namespace inviwo
@@ -0,0 +1,192 @@
+/*
+ * The error computation and the triangle traversal in buildTIN are adapted from Martini
+ * (https://github.com/mapbox/martini), under the following license:
+ *
+ * ISC License
+ *
+ * Copyright (c) 2019, Mapbox
+ *
+ * Permission to use, copy, modify, and/or distribute this software for any purpose with or without
+ * fee is hereby granted, provided that the above copyright notice and this permission notice
+ * appear in all copies.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES WITH REGARD TO THIS
+ * SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE
+ * AUTHOR BE LIABLE FOR ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+ * WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN ACTION OF CONTRACT,
+ * NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+ * OF THIS SOFTWARE.
+ */
+
+#include <modules/tnm067lab1/utils/heightfieldtin.h>
+#include <modules/tnm067lab1/utils/interpolationmethods.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace inviwo {
+
+namespace heightfield {
+
+namespace {
+
+// Bilinear resampling of the corner values onto a gridSize x gridSize grid
+std::vector<float> resample(const std::vector<float>& corners, size2_t cornerDims,
+                            size_t gridSize) {
+    if (cornerDims == size2_t(gridSize)) return corners;
+
+    const dvec2 scale = dvec2(cornerDims - size2_t(1)) / static_cast<double>(gridSize - 1);
+    auto at = [&](size_t x, size_t y) {
+        return corners[std::min(x, cornerDims.x - 1) +
+                       std::min(y, cornerDims.y - 1) * cornerDims.x];
+    };
+
+    std::vector<float> grid(gridSize * gridSize);
+    for (size_t j = 0; j < gridSize; ++j) {
+        for (size_t i = 0; i < gridSize; ++i) {
+            const dvec2 p = dvec2(i, j) * scale;
+            const size2_t p0(glm::floor(p));
+            const std::array<float, 4> v = {at(p0.x, p0.y), at(p0.x + 1, p0.y),
+                                            at(p0.x, p0.y + 1), at(p0.x + 1, p0.y + 1)};
+            grid[i + j * gridSize] =
+                TNM067::Interpolation::bilinear(v, p.x - p0.x, p.y - p0.y);
+        }
+    }
+    return grid;
+}
+
+}  // namespace
+
+TINResult buildTIN(const std::vector<float>& values, size2_t dims, float maxError,
+                   const ScalarToColorMapping& map, float scaleFactor) {
+    int tileSize = 1;
+    while (tileSize < static_cast<int>(std::max(dims.x, dims.y))) tileSize *= 2;
+    const int gridSize = tileSize + 1;
+
+    // Grid positions are ints, linear indices and counts are 64 bit since they exceed the int
+    // range for large heightfields
+    auto at = [gridSize](int x, int y) {
+        return static_cast<size_t>(x) + static_cast<size_t>(y) * static_cast<size_t>(gridSize);
+    };
+
+    const auto grid = resample(cornerValues(values, dims), dims + size2_t(1), gridSize);
+    auto height = [&](int x, int y) { return grid[at(x, y)] * scaleFactor; };
+
+    // Errors are compared relative to the height range, so that maxError does not depend on the
+    // value range of the image or on the scale factor
+    const auto [minValue, maxValue] = std::minmax_element(grid.begin(), grid.end());
+    const float heightRange = (*maxValue - *minValue) * std::abs(scaleFactor);
+    const float errorBound = maxError * heightRange;
+
+    // Every triangle in the hierarchy is identified by the two corners of its hypotenuse (a, b),
+    // the right angle corner c follows from them. The corners are derived from the triangle id
+    // when needed rather than stored, the id encodes the path of left/right halves from one of
+    // the two root triangles.
+    const auto cells = static_cast<std::int64_t>(tileSize) * tileSize;
+    const std::int64_t numTriangles = cells * 2 - 2;
+    const std::int64_t numParentTriangles = numTriangles - cells;
+
+    // Error at the midpoint of each hypotenuse, including the errors of all descendants, computed
+    // from the smallest triangles up
+    std::vector<float> errors(at(0, gridSize), 0.0f);
+    for (std::int64_t i = numTriangles - 1; i >= 0; --i) {
+        std::int64_t id = i + 2;
+        int ax = 0, ay = 0, bx = 0, by = 0, cx = 0, cy = 0;
+        if (id & 1) {
+            bx = by = cx = tileSize;  // bottom-left triangle
+        } else {
+            ax = ay = cy = tileSize;  // top-right triangle
+        }
+        while ((id >>= 1) > 1) {
+            const int mx = (ax + bx) >> 1;
+            const int my = (ay + by) >> 1;
+            if (id & 1) {  // left half
+                bx = ax;
+                by = ay;
+                ax = cx;
+                ay = cy;
+            } else {  // right half
+                ax = bx;
+                ay = by;
+                bx = cx;
+                by = cy;
+            }
+            cx = mx;
+            cy = my;
+        }
+
+        const int mx = (ax + bx) >> 1;
+        const int my = (ay + by) >> 1;
+
+        const float interpolated = 0.5f * (height(ax, ay) + height(bx, by));
+        float& error = errors[at(mx, my)];
+        error = std::max(error, std::abs(interpolated - height(mx, my)));
+
+        if (i < numParentTriangles) {
+            const size_t left = at((ax + cx) >> 1, (ay + cy) >> 1);
+            const size_t right = at((bx + cx) >> 1, (by + cy) >> 1);
+            error = std::max({error, errors[left], errors[right]});
+        }
+    }
+
+    TINResult result{MeshBuffers{}, 0.0f, 0};
+    auto& buffers = result.buffers;
+    std::vector<std::int64_t> vertexIds(at(0, gridSize), -1);
+    const float cellSize = 1.0f / tileSize;
+
+    auto vertex = [&](int x, int y) -> std::uint32_t {
+        auto& id = vertexIds[at(x, y)];
+        if (id < 0) {
+            id = static_cast<std::int64_t>(buffers.positions.size());
+            const float value = grid[at(x, y)];
+
+            // Normal from central differences on the full resolution grid
+            const int x0 = std::max(x - 1, 0), x1 = std::min(x + 1, tileSize);
+            const int y0 = std::max(y - 1, 0), y1 = std::min(y + 1, tileSize);
+            const float dx = (height(x1, y) - height(x0, y)) / ((x1 - x0) * cellSize);
+            const float dz = (height(x, y1) - height(x, y0)) / ((y1 - y0) * cellSize);
+
+            buffers.positions.emplace_back(x * cellSize, value * scaleFactor, y * cellSize);
+            buffers.normals.push_back(glm::normalize(vec3(-dx, 1.0f, -dz)));
+            buffers.colors.push_back(map.sample(value));
+        }
+        return static_cast<std::uint32_t>(id);
+    };
+
+    auto addTriangle = [&](int ax, int ay, int bx, int by, int cx, int cy) {
+        // Same winding as the top faces of the boxes
+        if ((bx - ax) * (cy - ay) - (by - ay) * (cx - ax) < 0) {
+            std::swap(bx, cx);
+            std::swap(by, cy);
+        }
+        buffers.indices.insert(buffers.indices.end(),
+                               {vertex(ax, ay), vertex(bx, by), vertex(cx, cy)});
+        ++result.triangles;
+    };
+
+    auto processTriangle = [&](auto& self, int ax, int ay, int bx, int by, int cx,
+                               int cy) -> void {
+        const int mx = (ax + bx) >> 1;
+        const int my = (ay + by) >> 1;
+        const bool isLeaf = std::abs(ax - cx) + std::abs(ay - cy) <= 1;
+        const float error = isLeaf ? 0.0f : errors[at(mx, my)];
+        if (error > errorBound) {
+            self(self, cx, cy, ax, ay, mx, my);
+            self(self, bx, by, cx, cy, mx, my);
+        } else {
+            result.maxError = std::max(result.maxError, heightRange > 0.0f ? error / heightRange
+                                                                           : 0.0f);
+            addTriangle(ax, ay, bx, by, cx, cy);
+        }
+    };
+    processTriangle(processTriangle, 0, 0, tileSize, tileSize, tileSize, 0);
+    processTriangle(processTriangle, tileSize, tileSize, 0, 0, 0, tileSize);
+
+    return result;
+}
+
+}  // namespace heightfield
+
+}  // namespace inviwo
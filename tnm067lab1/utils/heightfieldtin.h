@@ -0,0 +1,35 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/utils/heightfieldmesh.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+
+#include <vector>
+
+namespace inviwo {
+
+namespace heightfield {
+
+struct IVW_MODULE_TNM067LAB1_API TINResult {
+    MeshBuffers buffers;
+    float maxError;    // Largest vertical error of the emitted triangles, see buildTIN
+    size_t triangles;  // Number of emitted triangles
+};
+
+/**
+ * Error bounded adaptive triangulation of a heightfield, using a right-triangulated irregular
+ * network (restricted quadtree / longest edge bisection). The pixel corner values are resampled
+ * onto a (2^k + 1)^2 grid, the approximation error of every triangle in the bisection hierarchy
+ * is computed bottom-up and triangles are then only split where the error exceeds \p maxError.
+ * The result is crack free. Errors are vertical distances relative to the height range of the
+ * heightfield, i.e. \p maxError 0.01 allows an error of 1% of the distance between the lowest and
+ * the highest point, independent of \p scaleFactor. They are measured against the bilinearly
+ * resampled (2^k + 1)^2 grid of pixel corner values, not against the input pixels themselves.
+ */
+IVW_MODULE_TNM067LAB1_API TINResult buildTIN(const std::vector<float>& values, size2_t dims,
+                                             float maxError, const ScalarToColorMapping& map,
+                                             float scaleFactor);
+
+}  // namespace heightfield
+
+}  // namespace inviwo
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <modules/tnm067lab1/processors/imageupsampler.h>
+#include <modules/tnm067lab1/utils/interpolationmethods.h>
+
+#include <array>
+
+namespace inviwo {
+
+namespace TNM067 {
+
+/**
+ * Samples a single channel image at the continuous pixel coordinates \p coords using \p method.
+ * Pixels outside of the image are clamped to the border. Shared by all processors that
+ * resample an image on the fly.
+ */
+template <typename T>
+T sample(ImageUpsampler::IntepolationMethod method, const T* pixels, size2_t dims,
+         dvec2 coords) {
+    auto index = [&dims](auto pos) -> size_t {
+        pos = glm::clamp(pos, decltype(pos)(0), decltype(pos)(dims - size2_t(1)));
+        return pos.x + pos.y * dims.x;
+    };
+
+    switch (method) {
+        case ImageUpsampler::IntepolationMethod::PiecewiseConstant: {
+            return pixels[index(round(coords))];
+        }
+        case ImageUpsampler::IntepolationMethod::Bilinear: {
+            const ivec2 intPos = floor(coords);
+            const std::array<T, 4> edges = {
+                pixels[index(intPos)],                // Top left (2x2)
+                pixels[index(intPos + ivec2(1, 0))],  // Top right
+                pixels[index(intPos + ivec2(0, 1))],  // bottom left
+                pixels[index(intPos + ivec2(1, 1))],  // bottom right
+            };
+            return Interpolation::bilinear(edges, coords.x - intPos.x, coords.y - intPos.y);
+        }
+        case ImageUpsampler::IntepolationMethod::Biquadratic: {
+            const ivec2 intPos = floor(coords);
+            const std::array<T, 9> supportPoints = {
+                pixels[index(intPos)],                // bottom left
+                pixels[index(intPos + ivec2(1, 0))],  // bottom center
+                pixels[index(intPos + ivec2(2, 0))],  // bottom right
+                pixels[index(intPos + ivec2(0, 1))],  // center left
+                pixels[index(intPos + ivec2(1, 1))],  // center center
+                pixels[index(intPos + ivec2(2, 1))],  // center right
+                pixels[index(intPos + ivec2(0, 2))],  // top left
+                pixels[index(intPos + ivec2(1, 2))],  // top center
+                pixels[index(intPos + ivec2(2, 2))],  // Top right
+            };
+            return Interpolation::biQuadratic(supportPoints, (coords.x - intPos.x) / 2.0,
+                                              (coords.y - intPos.y) / 2.0);
+        }
+        case ImageUpsampler::IntepolationMethod::Barycentric: {
+            const ivec2 intPos = floor(coords);
+            const std::array<T, 4> edges = {
+                pixels[index(intPos)],                // Top left (2x2)
+                pixels[index(intPos + ivec2(1, 0))],  // Top right
+                pixels[index(intPos + ivec2(0, 1))],  // bottom left
+                pixels[index(intPos + ivec2(1, 1))],  // bottom right
+            };
+            return Interpolation::barycentric(edges, coords.x - intPos.x, coords.y - intPos.y);
+        }
+        default:
+            return T(0);
+    }
+}
+
+}  // namespace TNM067
+
+}  // namespace inviwo
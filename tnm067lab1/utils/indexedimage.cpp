@@ -0,0 +1,66 @@
+#include <modules/tnm067lab1/utils/indexedimage.h>
+#include <inviwo/core/datastructures/image/layerramprecision.h>
+#include <inviwo/core/metadata/metadata.h>
+#include <inviwo/core/util/imageramutils.h>
+
+namespace inviwo {
+
+namespace util {
+
+namespace {
+const std::string paletteKey = "org.inviwo.tnm067.palette";
+}
+
+std::vector<vec4> createPalette(const ScalarToColorMapping& map) {
+    std::vector<vec4> palette(paletteSize);
+    for (size_t i = 0; i < paletteSize; ++i) {
+        palette[i] = map.sample(static_cast<float>(i) / (paletteSize - 1));
+    }
+    return palette;
+}
+
+void setPalette(Image& image, const std::vector<vec4>& palette) {
+    image.setMetaData<StdVectorMetaData<vec4>>(paletteKey, palette);
+}
+
+std::vector<vec4> getPalette(const Image& image) {
+    if (auto md = image.getMetaData<StdVectorMetaData<vec4>>(paletteKey)) {
+        return md->get();
+    }
+    return {};
+}
+
+bool isIndexedImage(const Image& image) {
+    return image.getDataFormat() == DataUInt8::get() &&
+           image.getMetaData<StdVectorMetaData<vec4>>(paletteKey) != nullptr;
+}
+
+std::shared_ptr<const Image> expandIndexedImage(std::shared_ptr<const Image> image) {
+    if (!isIndexedImage(*image)) return image;
+
+    std::vector<glm::u8vec4> palette;
+    for (const auto& c : getPalette(*image)) {
+        palette.push_back(c * 255.f);
+    }
+    palette.resize(paletteSize, glm::u8vec4(0));
+
+    auto img = std::make_shared<Image>(image->getDimensions(), DataVec4UInt8::get());
+    auto outRep = static_cast<LayerRAMPrecision<glm::u8vec4>*>(
+        img->getColorLayer()->getEditableRepresentation<LayerRAM>());
+    auto inRep = static_cast<const LayerRAMPrecision<unsigned char>*>(
+        image->getColorLayer()->getRepresentation<LayerRAM>());
+
+    const unsigned char* indices = inRep->getDataTyped();
+    glm::u8vec4* outPixels = outRep->getDataTyped();
+    const size2_t dims = image->getDimensions();
+    util::forEachPixelParallel(*outRep, [&](size2_t pos) {
+        const auto i = pos.x + pos.y * dims.x;
+        outPixels[i] = palette[indices[i]];
+    });
+
+    return img;
+}
+
+}  // namespace util
+
+}  // namespace inviwo
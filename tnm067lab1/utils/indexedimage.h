@@ -0,0 +1,46 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/datastructures/image/image.h>
+#include <modules/tnm067lab1/utils/scalartocolormapping.h>
+
+#include <memory>
+#include <vector>
+
+namespace inviwo {
+
+namespace util {
+
+/**
+ * Palette indexed images store one uint8 index per pixel in the color layer and the RGBA palette
+ * as meta data on the image. Consumers that need RGBA can call expandIndexedImage. Values are
+ * quantized to the paletteSize entries, i.e. to 8 bits, regardless of the input precision.
+ */
+constexpr size_t paletteSize = 256;
+
+/**
+ * Samples \p map at paletteSize evenly spaced positions in [0,1].
+ */
+IVW_MODULE_TNM067LAB1_API std::vector<vec4> createPalette(const ScalarToColorMapping& map);
+
+/**
+ * Index of the palette entry closest to the normalized value \p t.
+ */
+inline unsigned char paletteIndex(float t) {
+    return static_cast<unsigned char>(glm::clamp(t, 0.0f, 1.0f) * (paletteSize - 1) + 0.5f);
+}
+
+IVW_MODULE_TNM067LAB1_API void setPalette(Image& image, const std::vector<vec4>& palette);
+IVW_MODULE_TNM067LAB1_API std::vector<vec4> getPalette(const Image& image);
+IVW_MODULE_TNM067LAB1_API bool isIndexedImage(const Image& image);
+
+/**
+ * Creates a DataVec4UInt8 image by looking up each index of \p image in its palette.
+ * Images without a palette are returned as is.
+ */
+IVW_MODULE_TNM067LAB1_API std::shared_ptr<const Image> expandIndexedImage(
+    std::shared_ptr<const Image> image);
+
+}  // namespace util
+
+}  // namespace inviwo
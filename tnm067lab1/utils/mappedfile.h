@@ -0,0 +1,35 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+
+#include <cstddef>
+#include <string>
+
+namespace inviwo {
+
+/**
+ * \class MappedFile
+ * \brief Read only memory mapping of a whole file
+ * The mapping is released on destruction. isOpen() is false if the file could not be mapped.
+ */
+class IVW_MODULE_TNM067LAB1_API MappedFile {
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isOpen() const { return data_ != nullptr; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    void* file_ = nullptr;
+    void* mapping_ = nullptr;
+#endif
+};
+
+}  // namespace inviwo
@@ -0,0 +1,340 @@
+#include <modules/tnm067lab1/utils/meshio.h>
+#include <modules/tnm067lab1/utils/mappedfile.h>
+#include <inviwo/core/datastructures/buffer/buffer.h>
+#include <inviwo/core/datastructures/buffer/bufferram.h>
+#include <inviwo/core/util/formatdispatching.h>
+#include <inviwo/core/util/logcentral.h>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace inviwo {
+
+namespace meshio {
+
+namespace {
+
+// All files are written in the byte order of the host, which is little endian on all supported
+// platforms
+
+constexpr char rawMagic[8] = {'T', 'N', 'M', 'M', 'E', 'S', 'H', '1'};
+constexpr std::uint64_t rawAlignment = 16;
+
+struct RawHeader {
+    char magic[8];
+    std::uint32_t numBuffers;
+    std::uint32_t numIndexBuffers;
+    std::uint32_t drawType;
+    std::uint32_t connectivity;
+    float modelMatrix[16];
+};
+
+// One entry per buffer followed by one per index buffer. For index buffers type and format hold
+// the draw type and connectivity.
+struct RawEntry {
+    std::uint32_t type;
+    std::uint32_t format;
+    std::int32_t location;
+    std::uint32_t elementSize;
+    std::uint64_t count;
+    std::uint64_t offset;  // From the start of the file
+};
+
+std::uint64_t align(std::uint64_t offset) {
+    return (offset + rawAlignment - 1) / rawAlignment * rawAlignment;
+}
+
+const BufferRAM* ram(const BufferBase& buffer) { return buffer.getRepresentation<BufferRAM>(); }
+
+// Enum values are read as integers, only the ones below the count of the enum are valid
+template <typename Enum>
+bool isValid(std::uint32_t value, Enum count) {
+    return value < static_cast<std::uint32_t>(count);
+}
+
+struct CreateBuffer {
+    template <typename Result, typename Format>
+    Result operator()(const char* data, size_t count) {
+        using T = typename Format::type;
+        std::vector<T> values(count);
+        std::memcpy(values.data(), data, count * sizeof(T));
+        return util::makeBuffer(std::move(values));
+    }
+};
+
+}  // namespace
+
+bool writePLY(const Mesh& mesh, const std::string& path) {
+    const BufferBase* positions = nullptr;
+    const BufferBase* normals = nullptr;
+    const BufferBase* colors = nullptr;
+    for (const auto& buffer : mesh.getBuffers()) {
+        switch (buffer.first.type) {
+            case BufferType::PositionAttrib:
+                positions = buffer.second.get();
+                break;
+            case BufferType::NormalAttrib:
+                if (buffer.second->getDataFormat()->getId() == DataFormatId::Vec3Float32) {
+                    normals = buffer.second.get();
+                }
+                break;
+            case BufferType::ColorAttrib: {
+                const auto id = buffer.second->getDataFormat()->getId();
+                if (id == DataFormatId::Vec4Float32 || id == DataFormatId::Vec4UInt8) {
+                    colors = buffer.second.get();
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    if (!positions) {
+        LogErrorCustom("meshio", "Can not write a mesh without positions to " << path);
+        return false;
+    }
+
+    // Only plain triangle lists are written as faces
+    std::vector<const IndexBuffer*> triangles;
+    size_t numTriangles = 0;
+    for (const auto& indices : mesh.getIndexBuffers()) {
+        if (indices.first.dt == DrawType::Triangles &&
+            indices.first.ct == ConnectivityType::None) {
+            triangles.push_back(indices.second.get());
+            numTriangles += indices.second->getSize() / 3;
+        }
+    }
+
+    const size_t numVertices = positions->getSize();
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    std::ostringstream header;
+    header << "ply\nformat binary_little_endian 1.0\n"
+           << "element vertex " << numVertices << "\n"
+           << "property float x\nproperty float y\nproperty float z\n";
+    if (normals) header << "property float nx\nproperty float ny\nproperty float nz\n";
+    if (colors) {
+        header << "property uchar red\nproperty uchar green\nproperty uchar blue\n"
+               << "property uchar alpha\n";
+    }
+    header << "element face " << numTriangles << "\n"
+           << "property list uchar uint vertex_indices\nend_header\n";
+    const auto headerString = header.str();
+    file.write(headerString.data(), headerString.size());
+
+    const size_t vertexSize = 3 * sizeof(float) + (normals ? 3 * sizeof(float) : 0) +
+                              (colors ? 4 * sizeof(std::uint8_t) : 0);
+    constexpr size_t chunkSize = 1 << 16;
+    std::vector<char> chunk(chunkSize * vertexSize);
+
+    // Float vec3 positions with an identity model matrix are copied as is, everything else goes
+    // through the generic conversion. Normals are transformed by the inverse transpose of the
+    // model matrix, which keeps them perpendicular to the surface under non-uniform scaling.
+    const auto positionRAM = ram(*positions);
+    const mat4 modelMatrix = mesh.getModelMatrix();
+    const bool identity = modelMatrix == mat4(1.0f);
+    const bool copyPositions =
+        positions->getDataFormat()->getId() == DataFormatId::Vec3Float32 && identity;
+    const mat3 normalMatrix = glm::transpose(glm::inverse(mat3(modelMatrix)));
+    const auto positionData = static_cast<const vec3*>(positionRAM->getData());
+    const auto normalData = normals ? static_cast<const vec3*>(ram(*normals)->getData()) : nullptr;
+    const auto colorRAM = colors ? ram(*colors) : nullptr;
+    const bool byteColors = colors && colors->getDataFormat()->getId() == DataFormatId::Vec4UInt8;
+
+    for (size_t begin = 0; begin < numVertices; begin += chunkSize) {
+        const size_t end = std::min(begin + chunkSize, numVertices);
+        char* out = chunk.data();
+        for (size_t i = begin; i < end; ++i) {
+            const vec3 p = copyPositions
+                               ? positionData[i]
+                               : vec3(modelMatrix * vec4(vec3(positionRAM->getAsDVec3(i)), 1.0f));
+            std::memcpy(out, &p, sizeof(vec3));
+            out += sizeof(vec3);
+            if (normalData) {
+                const vec3 n =
+                    identity ? normalData[i] : glm::normalize(normalMatrix * normalData[i]);
+                std::memcpy(out, &n, sizeof(vec3));
+                out += sizeof(vec3);
+            }
+            if (colorRAM) {
+                glm::u8vec4 c;
+                if (byteColors) {
+                    c = static_cast<const glm::u8vec4*>(colorRAM->getData())[i];
+                } else {
+                    const vec4 color = static_cast<const vec4*>(colorRAM->getData())[i];
+                    c = glm::u8vec4(glm::clamp(color, 0.0f, 1.0f) * 255.0f);
+                }
+                std::memcpy(out, &c, sizeof(c));
+                out += sizeof(c);
+            }
+        }
+        file.write(chunk.data(), out - chunk.data());
+    }
+
+    constexpr size_t faceSize = sizeof(std::uint8_t) + 3 * sizeof(std::uint32_t);
+    chunk.resize(chunkSize * faceSize);
+    for (const auto indexBuffer : triangles) {
+        const auto& indices = indexBuffer->getRAMRepresentation()->getDataContainer();
+        const size_t count = indices.size() / 3;
+        for (size_t begin = 0; begin < count; begin += chunkSize) {
+            const size_t end = std::min(begin + chunkSize, count);
+            char* out = chunk.data();
+            for (size_t i = begin; i < end; ++i) {
+                *out++ = 3;
+                std::memcpy(out, &indices[3 * i], 3 * sizeof(std::uint32_t));
+                out += 3 * sizeof(std::uint32_t);
+            }
+            file.write(chunk.data(), out - chunk.data());
+        }
+    }
+
+    return static_cast<bool>(file);
+}
+
+bool writeRaw(const Mesh& mesh, const std::string& path) {
+    const auto& buffers = mesh.getBuffers();
+    const auto& indexBuffers = mesh.getIndexBuffers();
+
+    RawHeader header{};
+    std::copy(std::begin(rawMagic), std::end(rawMagic), header.magic);
+    header.numBuffers = static_cast<std::uint32_t>(buffers.size());
+    header.numIndexBuffers = static_cast<std::uint32_t>(indexBuffers.size());
+    header.drawType = static_cast<std::uint32_t>(mesh.getDefaultMeshInfo().dt);
+    header.connectivity = static_cast<std::uint32_t>(mesh.getDefaultMeshInfo().ct);
+    const mat4 modelMatrix = mesh.getModelMatrix();
+    std::memcpy(header.modelMatrix, glm::value_ptr(modelMatrix), sizeof(header.modelMatrix));
+
+    // Lay out the blocks after the header and entries
+    std::vector<RawEntry> entries;
+    std::vector<const void*> blocks;
+    std::uint64_t offset =
+        align(sizeof(RawHeader) + (buffers.size() + indexBuffers.size()) * sizeof(RawEntry));
+    auto addEntry = [&](std::uint32_t type, std::uint32_t format, std::int32_t location,
+                        const BufferRAM* data) {
+        const auto elementSize = static_cast<std::uint32_t>(data->getDataFormat()->getSize());
+        entries.push_back({type, format, location, elementSize, data->getSize(), offset});
+        blocks.push_back(data->getData());
+        offset = align(offset + elementSize * data->getSize());
+    };
+    for (const auto& buffer : buffers) {
+        addEntry(static_cast<std::uint32_t>(buffer.first.type),
+                 static_cast<std::uint32_t>(buffer.second->getDataFormat()->getId()),
+                 buffer.first.location, ram(*buffer.second));
+    }
+    for (const auto& indices : indexBuffers) {
+        addEntry(static_cast<std::uint32_t>(indices.first.dt),
+                 static_cast<std::uint32_t>(indices.first.ct), -1, ram(*indices.second));
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(RawEntry));
+
+    std::uint64_t written = sizeof(header) + entries.size() * sizeof(RawEntry);
+    const char padding[rawAlignment] = {};
+    for (size_t i = 0; i < entries.size(); ++i) {
+        file.write(padding, entries[i].offset - written);
+        const auto bytes = entries[i].elementSize * entries[i].count;
+        file.write(static_cast<const char*>(blocks[i]), bytes);
+        written = entries[i].offset + bytes;
+    }
+
+    return static_cast<bool>(file);
+}
+
+std::shared_ptr<Mesh> readRaw(const std::string& path) {
+    MappedFile file(path);
+    if (!file.isOpen() || file.size() < sizeof(RawHeader)) {
+        LogErrorCustom("meshio", "Could not read " << path);
+        return nullptr;
+    }
+
+    RawHeader header;
+    std::memcpy(&header, file.data(), sizeof(header));
+    const size_t numEntries = size_t{header.numBuffers} + header.numIndexBuffers;
+    if (!std::equal(std::begin(rawMagic), std::end(rawMagic), header.magic) ||
+        numEntries > (file.size() - sizeof(RawHeader)) / sizeof(RawEntry)) {
+        LogErrorCustom("meshio", path << " is not a raw mesh");
+        return nullptr;
+    }
+    if (!isValid(header.drawType, DrawType::NumberOfDrawTypes) ||
+        !isValid(header.connectivity, ConnectivityType::NumberOfConnectivityTypes)) {
+        LogErrorCustom("meshio", path << " has an unknown draw type or connectivity");
+        return nullptr;
+    }
+    std::vector<RawEntry> entries(numEntries);
+    std::memcpy(entries.data(), file.data() + sizeof(RawHeader), numEntries * sizeof(RawEntry));
+    for (size_t i = 0; i < numEntries; ++i) {
+        const auto& entry = entries[i];
+        // The element size must match what the block is read as: the size of the data format for
+        // buffers and 32 bit indices for index buffers
+        size_t expectedSize = sizeof(std::uint32_t);
+        if (i < header.numBuffers) {
+            if (!isValid(entry.type, BufferType::NumberOfBufferTypes)) {
+                LogErrorCustom("meshio", path << " has a buffer of unknown type " << entry.type);
+                return nullptr;
+            }
+            if (entry.format == static_cast<std::uint32_t>(DataFormatId::NotSpecialized) ||
+                entry.format >= static_cast<std::uint32_t>(DataFormatId::NumberOfFormats)) {
+                LogErrorCustom("meshio",
+                               path << " has a buffer of unknown format " << entry.format);
+                return nullptr;
+            }
+            expectedSize = DataFormatBase::get(static_cast<DataFormatId>(entry.format))->getSize();
+        } else if (!isValid(entry.type, DrawType::NumberOfDrawTypes) ||
+                   !isValid(entry.format, ConnectivityType::NumberOfConnectivityTypes)) {
+            LogErrorCustom("meshio",
+                           path << " has an index buffer of unknown draw type or connectivity");
+            return nullptr;
+        }
+        if (entry.elementSize != expectedSize) {
+            LogErrorCustom("meshio", path << " has a buffer with elements of " << entry.elementSize
+                                          << " bytes, expected " << expectedSize);
+            return nullptr;
+        }
+        // Written as divisions so that a corrupt offset or count cannot wrap around
+        if (entry.offset > file.size() ||
+            entry.count > (file.size() - entry.offset) / entry.elementSize) {
+            LogErrorCustom("meshio", path << " is truncated");
+            return nullptr;
+        }
+    }
+
+    auto mesh = std::make_shared<Mesh>(static_cast<DrawType>(header.drawType),
+                                       static_cast<ConnectivityType>(header.connectivity));
+    mat4 modelMatrix;
+    std::memcpy(glm::value_ptr(modelMatrix), header.modelMatrix, sizeof(header.modelMatrix));
+    mesh->setModelMatrix(modelMatrix);
+
+    for (size_t i = 0; i < header.numBuffers; ++i) {
+        const auto& entry = entries[i];
+        auto buffer =
+            dispatching::dispatch<std::shared_ptr<BufferBase>, dispatching::filter::All>(
+                static_cast<DataFormatId>(entry.format), CreateBuffer{},
+                file.data() + entry.offset, static_cast<size_t>(entry.count));
+        mesh->addBuffer(Mesh::BufferInfo(static_cast<BufferType>(entry.type), entry.location),
+                        buffer);
+    }
+    for (size_t i = header.numBuffers; i < numEntries; ++i) {
+        const auto& entry = entries[i];
+        std::vector<std::uint32_t> indices(entry.count);
+        std::memcpy(indices.data(), file.data() + entry.offset,
+                    indices.size() * sizeof(std::uint32_t));
+        mesh->addIndices(Mesh::MeshInfo(static_cast<DrawType>(entry.type),
+                                        static_cast<ConnectivityType>(entry.format)),
+                         util::makeIndexBuffer(std::move(indices)));
+    }
+
+    return mesh;
+}
+
+}  // namespace meshio
+
+}  // namespace inviwo
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/datastructures/geometry/mesh.h>
+
+#include <memory>
+#include <string>
+
+namespace inviwo {
+
+namespace meshio {
+
+/**
+ * Writes the triangles of \p mesh as binary little endian PLY. Positions are written with the
+ * model matrix applied and vec3 float normals with its inverse transpose, vec4 float or u8vec4
+ * colors are written if present. The vertices are interleaved in chunks so the file is written
+ * with large sequential writes. Returns false if the file could not be written.
+ */
+IVW_MODULE_TNM067LAB1_API bool writePLY(const Mesh& mesh, const std::string& path);
+
+/**
+ * Writes all buffers and index buffers of \p mesh in the raw mesh format: a small header
+ * followed by the data of each buffer as one block, written directly from the buffer containers
+ * without conversion. Returns false if the file could not be written.
+ */
+IVW_MODULE_TNM067LAB1_API bool writeRaw(const Mesh& mesh, const std::string& path);
+
+/**
+ * Reads a mesh written by writeRaw. The file is memory mapped and each block is copied straight
+ * into its buffer. Returns nullptr if the file is not a valid raw mesh, i.e. if it is truncated
+ * or holds an unknown buffer type, data format, draw type or connectivity.
+ */
+IVW_MODULE_TNM067LAB1_API std::shared_ptr<Mesh> readRaw(const std::string& path);
+
+}  // namespace meshio
+
+}  // namespace inviwo
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <modules/tnm067lab1/tnm067lab1moduledefine.h>
+#include <inviwo/core/common/inviwoapplication.h>
+
+#include <algorithm>
+#include <exception>
+#include <future>
+#include <vector>
+
+namespace inviwo {
+
+namespace util {
+
+/**
+ * Calls callback(job) for each job in [0, jobs) on the thread pool and waits for all of them to
+ * finish. The jobs are split into a few contiguous chunks per pool thread, so that small jobs do
+ * not pay for one pool task each. All chunks are waited for before the first exception thrown by
+ * a job is rethrown here, callback is never used after returning. Runs serially if the pool has no
+ * threads or if there is no application, as in the unit tests.
+ */
+template <typename C>
+void forEachJobParallel(size_t jobs, C callback) {
+    const size_t poolSize =
+        InviwoApplication::isInitialized() ? InviwoApplication::getPtr()->getPoolSize() : 0;
+    if (poolSize == 0 || jobs <= 1) {
+        for (size_t job = 0; job < jobs; ++job) {
+            callback(job);
+        }
+        return;
+    }
+
+    constexpr size_t chunksPerThread = 4;
+    const size_t chunks = std::min(jobs, poolSize * chunksPerThread);
+    std::vector<std::future<void>> futures;
+    futures.reserve(chunks);
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+        const size_t begin = jobs * chunk / chunks;
+        const size_t end = jobs * (chunk + 1) / chunks;
+        futures.push_back(dispatchPool([&callback, begin, end]() {
+            for (size_t job = begin; job < end; ++job) {
+                callback(job);
+            }
+        }));
+    }
+
+    std::exception_ptr error;
+    for (auto& f : futures) {
+        try {
+            f.get();
+        } catch (...) {
+            if (!error) error = std::current_exception();
+        }
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+}  // namespace util
+
+}  // namespace inviwo
@@ -1,12 +1,36 @@
 #include <modules/tnm067lab2/processors/hydrogengenerator.h>
 #include <inviwo/core/datastructures/volume/volume.h>
 #include <inviwo/core/util/volumeramutils.h>
-#include <modules/base/algorithm/dataminmax.h>
 #include <inviwo/core/util/indexmapper.h>
 #include <inviwo/core/datastructures/volume/volumeram.h>
-#include <modules/base/algorithm/dataminmax.h>
+#include <inviwo/core/util/filesystem.h>
+#include <inviwo/core/util/logcentral.h>
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <future>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <sys/utime.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+#endif
 
 namespace inviwo {
 
@@ -21,25 +45,472 @@ const ProcessorInfo HydrogenGenerator::processorInfo_{
 const ProcessorInfo HydrogenGenerator::getProcessorInfo() const { return processorInfo_; }
 
 HydrogenGenerator::HydrogenGenerator()
-    : Processor(), volume_("volume"), size_("size_", "Volume Size", 16, 4, 256) {
+    : Processor()
+    , volume_("volume")
+    , size_("size_", "Volume Size", 16, 4, 1024)
+    , evaluationMode_("evaluationMode", "Evaluation",
+                      {{"exact", "Exact", EvaluationMode::Exact},
+                       {"symmetric", "Symmetric", EvaluationMode::Symmetric},
+                       {"fast", "Fast", EvaluationMode::Fast},
+                       {"orbital", "Orbital (n, l, m)", EvaluationMode::Orbital}})
+    , n_("n", "Principal (n)", 3, 1, 8)
+    , l_("l", "Azimuthal (l)", 2, 0, 7)
+    , m_("m", "Magnetic (m)", 0, -7, 7)
+    , useCache_("useCache", "Disk Cache", false)
+    , cacheLimit_("cacheLimit", "Cache Limit (MB)", 8192, 64, 65536) {
     addPort(volume_);
     addProperty(size_);
+    addProperty(evaluationMode_);
+    addProperty(n_);
+    addProperty(l_);
+    addProperty(m_);
+    addProperty(useCache_);
+    addProperty(cacheLimit_);
+    auto isOrbitalMode = [](const auto& p) { return p.get() == EvaluationMode::Orbital; };
+    n_.visibilityDependsOn(evaluationMode_, isOrbitalMode);
+    l_.visibilityDependsOn(evaluationMode_, isOrbitalMode);
+    m_.visibilityDependsOn(evaluationMode_, isOrbitalMode);
+    cacheLimit_.visibilityDependsOn(useCache_, [](const auto& p) { return p.get(); });
+
+    // Keep 0 <= l < n and |m| <= l
+    auto updateM = [this]() {
+        m_.setMinValue(-l_.get());
+        m_.setMaxValue(l_.get());
+    };
+    auto updateL = [this, updateM]() {
+        l_.setMaxValue(n_.get() - 1);
+        updateM();
+    };
+    n_.onChange(updateL);
+    l_.onChange(updateM);
+    updateL();
+}
+
+HydrogenGenerator::~HydrogenGenerator() {
+    if (cacheWrite_.valid()) cacheWrite_.wait();
+}
+
+namespace {
+
+// Value range of the voxels written by one job
+struct ValueRange {
+    void add(float value) {
+        min = std::min(min, value);
+        max = std::max(max, value);
+    }
+    void add(const ValueRange& other) {
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    float min = std::numeric_limits<float>::max();
+    float max = std::numeric_limits<float>::lowest();
+};
+
+// Generated volumes are cached in the user settings directory as a header followed by the raw
+// float voxels, in the byte order of the host. The file name is a hash of the parameters in the
+// header, the full header is compared on load so a hash collision only causes a regeneration.
+// The modification time of a file is updated on every hit, and the files with the oldest times
+// are removed when the directory grows above the cache limit.
+
+constexpr char cacheMagic[8] = {'T', 'N', 'M', 'H', 'Y', 'D', 'R', '1'};
+
+struct CacheHeader {
+    char magic[8];
+    std::uint64_t size;
+    std::int32_t mode;
+    std::int32_t n;
+    std::int32_t l;
+    std::int32_t m;
+    double min;
+    double max;
+};
+
+bool sameParameters(const CacheHeader& a, const CacheHeader& b) {
+    return std::memcmp(a.magic, b.magic, sizeof(a.magic)) == 0 && a.size == b.size &&
+           a.mode == b.mode && a.n == b.n && a.l == b.l && a.m == b.m;
+}
+
+// 64 bit FNV-1a of the parameter fields, stable between runs and platforms
+std::string cacheFile(const CacheHeader& header) {
+    std::uint64_t hash = 14695981039346656037ull;
+    auto add = [&hash](const void* data, size_t size) {
+        auto bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    add(header.magic, sizeof(header.magic));
+    add(&header.size, sizeof(header.size));
+    add(&header.mode, sizeof(header.mode));
+    add(&header.n, sizeof(header.n));
+    add(&header.l, sizeof(header.l));
+    add(&header.m, sizeof(header.m));
+
+    std::ostringstream name;
+    name << filesystem::getPath(PathType::Settings, "/hydrogencache", true) << "/hydrogen-"
+         << std::hex << std::setw(16) << std::setfill('0') << hash << ".raw";
+    return name.str();
+}
+
+// Read only memory mapping of a whole file, released on destruction. Same as MappedFile in
+// tnm067lab1, which this module does not depend on.
+class MappedCacheFile {
+public:
+    explicit MappedCacheFile(const std::string& path);
+    ~MappedCacheFile();
+    MappedCacheFile(const MappedCacheFile&) = delete;
+    MappedCacheFile& operator=(const MappedCacheFile&) = delete;
+
+    bool isOpen() const { return data_ != nullptr; }
+    const char* data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef _WIN32
+    HANDLE file_ = nullptr;
+    HANDLE mapping_ = nullptr;
+#endif
+};
+
+#ifdef _WIN32
+
+MappedCacheFile::MappedCacheFile(const std::string& path) {
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        file_ = nullptr;
+        return;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_, &size) || size.QuadPart == 0) return;
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_) return;
+    data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+    if (data_) size_ = static_cast<size_t>(size.QuadPart);
+}
+
+MappedCacheFile::~MappedCacheFile() {
+    if (data_) UnmapViewOfFile(data_);
+    if (mapping_) CloseHandle(mapping_);
+    if (file_) CloseHandle(file_);
+}
+
+void touchCacheFile(const std::string& path) { _utime(path.c_str(), nullptr); }
+
+#else
+
+MappedCacheFile::MappedCacheFile(const std::string& path) {
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0) {
+        const auto size = static_cast<size_t>(info.st_size);
+        void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, size, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(data);
+            size_ = size;
+        }
+    }
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+MappedCacheFile::~MappedCacheFile() {
+    if (data_) munmap(const_cast<char*>(data_), size_);
+}
+
+void touchCacheFile(const std::string& path) { utime(path.c_str(), nullptr); }
+
+#endif
+
+// Copies the voxels from a mapping of the file into data, without the intermediate buffering
+// of a stream. Returns false, leaving header untouched, if there is no valid cache file for the
+// parameters in header.
+bool readCache(const std::string& path, CacheHeader& header, float* data, size_t count) {
+    const MappedCacheFile file(path);
+    if (!file.isOpen() || file.size() != sizeof(CacheHeader) + count * sizeof(float)) {
+        return false;
+    }
+
+    CacheHeader stored;
+    std::memcpy(&stored, file.data(), sizeof(stored));
+    if (!sameParameters(stored, header)) return false;
+    std::memcpy(data, file.data() + sizeof(stored), count * sizeof(float));
+
+    touchCacheFile(path);
+    header = stored;
+    return true;
+}
+
+// Removes the least recently used cache files in the directory of keep, but never keep itself,
+// until the files take at most limit bytes
+void evictCache(const std::string& keep, size_t limit) {
+    struct Entry {
+        std::string path;
+        std::time_t time;
+        size_t size;
+    };
+    const std::string directory = filesystem::getFileDirectory(keep);
+    std::vector<Entry> entries;
+    size_t total = 0;
+    for (const auto& file : filesystem::getDirectoryContents(directory)) {
+        const std::string name = filesystem::getFileNameWithExtension(file);
+        if (name.compare(0, 9, "hydrogen-") != 0 ||
+            filesystem::getFileExtension(name) != "raw") {
+            continue;
+        }
+        const std::string path = directory + "/" + name;
+        std::ifstream stream(path, std::ios::binary | std::ios::ate);
+        if (!stream) continue;
+        entries.push_back(
+            {path, filesystem::fileModificationTime(path), static_cast<size_t>(stream.tellg())});
+        total += entries.back().size;
+    }
+
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& a, const Entry& b) { return a.time < b.time; });
+    for (const auto& entry : entries) {
+        if (total <= limit) break;
+        if (entry.path == keep) continue;
+        if (std::remove(entry.path.c_str()) == 0) total -= entry.size;
+    }
+}
+
+// Writes to a temporary file that is renamed when complete, so that a concurrent or interrupted
+// write never leaves a truncated cache file behind. The temporary file is removed if the write
+// fails.
+bool writeCache(const std::string& path, const CacheHeader& header, const float* data,
+                size_t count) {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream file(tmp, std::ios::binary);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(data), count * sizeof(float));
+        if (!file) {
+            file.close();
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+    std::remove(path.c_str());
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        return false;
+    }
+    return true;
+}
+
+// exp(x) for x in [-87, 0] in single precision. Range reduction to x = k ln(2) + f with
+// |f| <= ln(2)/2 followed by a degree 6 polynomial for exp(f) and 2^k built directly in the
+// exponent bits. Relative error is below 1e-7. Written without branches or library calls so that
+// it can be inlined into vectorized loops.
+inline float fastExp(float x) {
+    // Truncation rounds to nearest since x - 0.5 is never positive
+    const auto k = static_cast<std::int32_t>(x * 1.44269504f - 0.5f);
+    const auto kf = static_cast<float>(k);
+    const float f = x - kf * 0.693145751953125f - kf * 1.428606765330187e-6f;
+
+    float p = 1.9875691500e-4f;
+    p = p * f + 1.3981999507e-3f;
+    p = p * f + 8.3334519073e-3f;
+    p = p * f + 4.1665795894e-2f;
+    p = p * f + 1.6666665459e-1f;
+    p = p * f + 5.0000001201e-1f;
+    p = p * f * f + f + 1.0f;
+
+    const std::int32_t bits = (k + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
 }
 
+}  // namespace
+
 void HydrogenGenerator::process() {
     auto vol = std::make_shared<Volume>(size3_t(size_), DataFloat32::get());
 
     auto ram = vol->getEditableRepresentation<VolumeRAM>();
     auto data = static_cast<float*>(ram->getData());
-    util::IndexMapper3D index(ram->getDimensions());
+    const size3_t dims = ram->getDimensions();
+    util::IndexMapper3D index(dims);
+    const size_t voxels = dims.x * dims.y * dims.z;
+
+    const bool orbital = evaluationMode_ == EvaluationMode::Orbital;
+    CacheHeader header{};
+    std::memcpy(header.magic, cacheMagic, sizeof(cacheMagic));
+    header.size = dims.x;
+    header.mode = static_cast<std::int32_t>(evaluationMode_.get());
+    header.n = orbital ? n_.get() : 3;
+    header.l = orbital ? std::min(l_.get(), n_.get() - 1) : 2;
+    header.m = orbital ? std::min(std::abs(m_.get()), static_cast<int>(header.l)) : 0;
+
+    std::string cachePath;
+    if (useCache_) {
+        cachePath = cacheFile(header);
+        if (readCache(cachePath, header, data, voxels)) {
+            vol->dataMap_.dataRange = vol->dataMap_.valueRange = dvec2(header.min, header.max);
+            volume_.setData(vol);
+            return;
+        }
+    }
+
+    // The value range is accumulated per slice while generating and merged afterwards, instead
+    // of a second pass over the volume. The mirrored octants hold the same values as the
+    // evaluated one and need not be visited. forEachVoxelParallel splits the volume into jobs of
+    // whole z-slices, so every slice range is only updated by one job.
+    std::vector<ValueRange> ranges(dims.z);
+
+    if (evaluationMode_ == EvaluationMode::Symmetric) {
+        // Squared coordinate of each index along an axis. The grid is symmetric around the
+        // origin, so index i and size - 1 - i have the same squared coordinate and only the
+        // first octant has to be evaluated.
+        std::vector<double> squared(dims.x);
+        for (size_t i = 0; i < dims.x; ++i) {
+            const double c = idTOCartesian(size3_t(i)).x;
+            squared[i] = c * c;
+        }
+        const size_t half = (dims.x + 1) / 2;
+        const size_t last = dims.x - 1;
+
+        util::forEachVoxelParallel(size3_t(half), [&](const size3_t& pos) {
+            const auto value =
+                static_cast<float>(evalSquared(squared[pos.x], squared[pos.y], squared[pos.z]));
+            ranges[pos.z].add(value);
+            for (const size_t mz : {pos.z, last - pos.z}) {
+                for (const size_t my : {pos.y, last - pos.y}) {
+                    data[index(size3_t(pos.x, my, mz))] = value;
+                    data[index(size3_t(last - pos.x, my, mz))] = value;
+                }
+            }
+        });
+    } else if (evaluationMode_ == EvaluationMode::Fast) {
+        std::vector<float> squared(dims.x);
+        for (size_t i = 0; i < dims.x; ++i) {
+            const float c = idTOCartesian(size3_t(i)).x;
+            squared[i] = c * c;
+        }
+        const size_t half = (dims.x + 1) / 2;
+        const size_t last = dims.x - 1;
 
-    util::forEachVoxel(*ram, [&](const size3_t& pos) {
-        vec3 cartesian = idTOCartesian(pos);
-        data[index(pos)] = static_cast<float>(eval(cartesian));
-    });
+        // One call per row of the first octant, the rows are evaluated as a whole
+        util::forEachVoxelParallel(size3_t(1, half, half), [&](const size3_t& pos) {
+            std::vector<float> row(half);
+            evalSquaredFast(squared.data(), squared[pos.y], squared[pos.z], row.data(), half);
+            for (const float value : row) {
+                ranges[pos.z].add(value);
+            }
+            for (const size_t mz : {pos.z, last - pos.z}) {
+                for (const size_t my : {pos.y, last - pos.y}) {
+                    float* dst = data + index(size3_t(0, my, mz));
+                    std::copy(row.begin(), row.end(), dst);
+                    for (size_t x = 0; x < half; ++x) {
+                        dst[last - x] = row[x];
+                    }
+                }
+            }
+        });
+    } else if (evaluationMode_ == EvaluationMode::Orbital) {
+        const int n = n_.get();
+        const int l = std::min(l_.get(), n - 1);
+        const int m = std::min(std::abs(m_.get()), l);
 
-    auto minMax = util::volumeMinMax(ram);
-    vol->dataMap_.dataRange = vol->dataMap_.valueRange = dvec2(minMax.first.x, minMax.second.x);
+        // The coordinate of index i is h * (2i - (size - 1)), so r^2 = h^2 * s for the integer
+        // s = a^2 + b^2 + c^2 of the offsets a, b, c. All offsets have the parity of size - 1,
+        // which makes s either 3 mod 8 or a multiple of 4. The radial factor is tabulated for
+        // those values of s and shared by all voxels at the same radius.
+        const auto last = static_cast<std::int64_t>(dims.x - 1);
+        const double h = 18.0 / static_cast<double>(last);
+        const bool oddOffsets = last % 2 == 1;
+        auto radialIndex = [oddOffsets](std::int64_t s) {
+            return static_cast<size_t>(oddOffsets ? (s - 3) / 8 : s / 4);
+        };
+
+        const size_t half = (dims.x + 1) / 2;
+        std::vector<std::int64_t> offset(half);
+        for (size_t i = 0; i < half; ++i) {
+            offset[i] = last - 2 * static_cast<std::int64_t>(i);
+        }
+
+        // radialTable holds R_nl^2 and invSquare holds 1 / s to get cos^2(theta) = c^2 / s. The
+        // angular factor is a polynomial of degree l in cos^2(theta), scaled by the normalization
+        // of Y_l^m, so no Legendre recurrence or square root is needed per voxel.
+        const size_t tableSize = radialIndex(3 * last * last) + 1;
+        std::vector<double> radialTable(tableSize);
+        std::vector<double> invSquare(tableSize);
+        for (size_t k = 0; k < tableSize; ++k) {
+            const auto s = static_cast<double>(oddOffsets ? 8 * k + 3 : 4 * k);
+            const double r = radial(n, l, h * std::sqrt(s));
+            radialTable[k] = r * r;
+            invSquare[k] = s > 0.0 ? 1.0 / s : 0.0;
+        }
+        auto angular = associatedLegendreSquared(l, m);
+        const double angularNorm = angularNormSquared(l, m);
+        for (auto& a : angular) {
+            a *= angularNorm;
+        }
+
+        const size_t lastIndex = dims.x - 1;
+        util::forEachVoxelParallel(size3_t(half), [&](const size3_t& pos) {
+            const std::int64_t c = offset[pos.z];
+            const std::int64_t s = offset[pos.x] * offset[pos.x] +
+                                   offset[pos.y] * offset[pos.y] + c * c;
+            const size_t k = radialIndex(s);
+            const double cos2Theta = static_cast<double>(c * c) * invSquare[k];
+            double p = angular.back();
+            for (size_t i = angular.size() - 1; i > 0; --i) {
+                p = p * cos2Theta + angular[i - 1];
+            }
+            const auto value = static_cast<float>(radialTable[k] * p);
+            ranges[pos.z].add(value);
+            for (const size_t mz : {pos.z, lastIndex - pos.z}) {
+                for (const size_t my : {pos.y, lastIndex - pos.y}) {
+                    data[index(size3_t(pos.x, my, mz))] = value;
+                    data[index(size3_t(lastIndex - pos.x, my, mz))] = value;
+                }
+            }
+        });
+    } else {
+        // Every voxel only depends on its own position, so the result does not depend on how
+        // the slices are scheduled. The size is read once here, properties are not accessed from
+        // the pool threads.
+        const size_t size = size_.get();
+        util::forEachVoxelParallel(dims, [&](const size3_t& pos) {
+            vec3 cartesian = idTOCartesian(pos, size);
+            const auto value = static_cast<float>(eval(cartesian));
+            data[index(pos)] = value;
+            ranges[pos.z].add(value);
+        });
+    }
+
+    ValueRange range;
+    for (const auto& r : ranges) {
+        range.add(r);
+    }
+    vol->dataMap_.dataRange = vol->dataMap_.valueRange = dvec2(range.min, range.max);
+
+    const size_t cacheLimit = cacheLimit_.get() * 1024 * 1024;
+    if (useCache_ && sizeof(CacheHeader) + voxels * sizeof(float) <= cacheLimit) {
+        header.min = range.min;
+        header.max = range.max;
+        // The write is done on a separate thread so that it does not delay the output. Outport
+        // data is not modified after it is set, so the thread reads the voxels of the published
+        // volume and keeps the volume alive until it is done. Only one write is in flight at a
+        // time. Volumes larger than the cache limit are not cached at all.
+        if (cacheWrite_.valid()) cacheWrite_.wait();
+        auto write = [cachePath, header, cacheLimit, volume = std::shared_ptr<const Volume>(vol),
+                      voxelData = static_cast<const float*>(data), voxels]() {
+            if (!writeCache(cachePath, header, voxelData, voxels)) {
+                LogWarnCustom("HydrogenGenerator", "Could not write volume cache " << cachePath);
+                return;
+            }
+            evictCache(cachePath, cacheLimit);
+        };
+        cacheWrite_ = std::async(std::launch::async, std::move(write));
+    }
 
     volume_.setData(vol);
 }
@@ -75,9 +546,157 @@ double HydrogenGenerator::eval(vec3 cartesian) {
     return pow(abs(density), 2);
 }
 
-vec3 HydrogenGenerator::idTOCartesian(size3_t pos) {
+double HydrogenGenerator::evalSquared(double x2, double y2, double z2) {
+    const double r2 = x2 + y2 + z2;
+    if (r2 < 10e-5 * 10e-5) return 0.0;  // Same cut off as cartesianToSpherical, where r^2 = 0
+
+    const double r = std::sqrt(r2);
+    const double cos2Theta = z2 / r2;
+
+    const double yellow = 1 / (81 * std::sqrt(6 * M_PI));
+    const double density = yellow * r2 * std::exp(-r / 3) * (3 * cos2Theta - 1);
+
+    return density * density;
+}
+
+void HydrogenGenerator::evalSquaredFast(const float* x2, float y2, float z2, float* out,
+                                        size_t count) {
+    // Same expression as evalSquared with r^2 * (3 cos^2(theta) - 1) = 3 z^2 - r^2, which is
+    // zero at the origin without a special case
+    const float yellow = static_cast<float>(1 / (81 * std::sqrt(6 * M_PI)));
+    const float yz2 = y2 + z2;
+    const float z2x3 = 3.0f * z2;
+
+    // std::sqrt may set errno, which keeps GCC and Clang from vectorizing a loop containing it
+    // unless -fno-math-errno is given. r is computed in a separate pass so that at least the
+    // density loop below is vectorized. Clamping r keeps the argument of fastExp in range.
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = std::min(std::sqrt(x2[i] + yz2), 261.0f);
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const float r2 = x2[i] + yz2;
+        const float density = yellow * (z2x3 - r2) * fastExp(out[i] * (-1.0f / 3.0f));
+        out[i] = density * density;
+    }
+}
+
+double HydrogenGenerator::associatedLaguerre(int k, int alpha, double x) {
+    if (k <= 0) return 1.0;
+
+    double prev = 1.0;
+    double curr = 1.0 + alpha - x;
+    for (int i = 1; i < k; ++i) {
+        const double next = ((2 * i + 1 + alpha - x) * curr - (i + alpha) * prev) / (i + 1);
+        prev = curr;
+        curr = next;
+    }
+    return curr;
+}
+
+double HydrogenGenerator::associatedLegendre(int l, int m, double x) {
+    // P_m^m = (-1)^m (2m - 1)!! (1 - x^2)^(m/2)
+    double pmm = 1.0;
+    if (m > 0) {
+        const double sinTheta = std::sqrt(std::max(0.0, (1.0 - x) * (1.0 + x)));
+        double fact = 1.0;
+        for (int i = 1; i <= m; ++i) {
+            pmm *= -fact * sinTheta;
+            fact += 2.0;
+        }
+    }
+    if (l == m) return pmm;
+
+    double prev = pmm;
+    double curr = x * (2 * m + 1) * pmm;
+    for (int i = m + 2; i <= l; ++i) {
+        const double next = (x * (2 * i - 1) * curr - (i + m - 1) * prev) / (i - m);
+        prev = curr;
+        curr = next;
+    }
+    return curr;
+}
+
+double HydrogenGenerator::radial(int n, int l, double r) {
+    // (n - l - 1)! / (n + l)!
+    double factorialRatio = 1.0;
+    for (int i = n - l; i <= n + l; ++i) {
+        factorialRatio /= i;
+    }
+    const double norm = std::sqrt(std::pow(2.0 / n, 3) * factorialRatio / (2.0 * n));
+
+    const double rho = 2.0 * r / n;
+    return norm * std::exp(-rho / 2) * std::pow(rho, l) *
+           associatedLaguerre(n - l - 1, 2 * l + 1, rho);
+}
+
+std::vector<double> HydrogenGenerator::associatedLegendreSquared(int l, int m) {
+    // P_l^m(x) = (1 - x^2)^(m/2) Q_l(x) where the polynomial Q_l follows the same recurrence as
+    // P_l^m, starting from Q_m = (-1)^m (2m - 1)!!. Coefficients by increasing power of x.
+    std::vector<double> prev;
+    std::vector<double> curr(1, 1.0);
+    for (int i = 1; i <= m; ++i) {
+        curr[0] *= -(2 * i - 1);
+    }
+    if (l > m) {
+        prev = curr;
+        curr = {0.0, (2 * m + 1) * prev[0]};
+        for (int i = m + 2; i <= l; ++i) {
+            std::vector<double> next(i - m + 1, 0.0);
+            for (size_t j = 0; j < curr.size(); ++j) {
+                next[j + 1] += (2 * i - 1) * curr[j];
+            }
+            for (size_t j = 0; j < prev.size(); ++j) {
+                next[j] -= (i + m - 1) * prev[j];
+            }
+            for (auto& a : next) {
+                a /= i - m;
+            }
+            prev = std::move(curr);
+            curr = std::move(next);
+        }
+    }
+
+    // Q_l has the parity of l - m, so Q_l^2 only has even powers of x. Multiplying by
+    // (1 - t)^m with t = x^2 then gives a polynomial of degree l in t.
+    std::vector<double> res(l + 1, 0.0);
+    for (size_t j = 0; j < curr.size(); ++j) {
+        for (size_t k = j % 2; k < curr.size(); k += 2) {
+            res[(j + k) / 2] += curr[j] * curr[k];
+        }
+    }
+    for (int i = 0; i < m; ++i) {
+        for (int j = l; j > 0; --j) {
+            res[j] -= res[j - 1];
+        }
+    }
+    return res;
+}
+
+double HydrogenGenerator::angularNormSquared(int l, int m) {
+    // (l - m)! / (l + m)!
+    double factorialRatio = 1.0;
+    for (int i = l - m + 1; i <= l + m; ++i) {
+        factorialRatio /= i;
+    }
+    return (2 * l + 1) / (4 * M_PI) * factorialRatio;
+}
+
+double HydrogenGenerator::evalOrbital(int n, int l, int m, vec3 cartesian) {
+    m = std::abs(m);
+    const dvec3 p(cartesian);
+    const double r = glm::length(p);
+    const double cosTheta = r > 0.0 ? p.z / r : 0.0;
+
+    const double radialPart = radial(n, l, r);
+    const double legendre = associatedLegendre(l, m, cosTheta);
+    return radialPart * radialPart * angularNormSquared(l, m) * legendre * legendre;
+}
+
+vec3 HydrogenGenerator::idTOCartesian(size3_t pos) { return idTOCartesian(pos, size_.get()); }
+
+vec3 HydrogenGenerator::idTOCartesian(size3_t pos, size_t size) {
     vec3 p(pos);
-    p /= size_ - 1;
+    p /= size - 1;
     return p * (36.0f) - 18.0f;
 }
 
@@ -3,15 +3,29 @@
 #include <modules/tnm067lab2/tnm067lab2moduledefine.h>
 #include <inviwo/core/processors/processor.h>
 #include <inviwo/core/properties/ordinalproperty.h>
+#include <inviwo/core/properties/optionproperty.h>
+#include <inviwo/core/properties/boolproperty.h>
 #include <inviwo/core/ports/imageport.h>
 #include <inviwo/core/ports/volumeport.h>
 
+#include <future>
+#include <vector>
+
 namespace inviwo {
 
 class IVW_MODULE_TNM067LAB2_API HydrogenGenerator : public Processor {
 public:
+    /**
+     * Exact: eval for every voxel.
+     * Symmetric: evalSquared for one octant, mirrored into the other seven.
+     * Fast: evalSquaredFast for one octant in single precision, mirrored like Symmetric.
+     * Orbital: any orbital given by (n, l, m), from a table of the radial factor per distinct
+     * radius on the grid. Mirrored like Symmetric.
+     */
+    enum class EvaluationMode { Exact, Symmetric, Fast, Orbital };
+
     HydrogenGenerator();
-    virtual ~HydrogenGenerator() = default;
+    virtual ~HydrogenGenerator();
 
     virtual void process() override;
 
@@ -20,13 +34,70 @@ public:
 
     static vec3 cartesianToSpherical(vec3 cartesian);
     static double eval(vec3 cartesian);
+    /**
+     * Same density as eval, from the squared coordinates. Uses cos(theta)^2 = z^2 / r^2
+     * directly, so no trigonometric functions are needed. The density only depends on squared
+     * coordinates and is therefore mirror symmetric in all three axes.
+     */
+    static double evalSquared(double x2, double y2, double z2);
+    /**
+     * Single precision version of evalSquared for a row of count voxels sharing y2 and z2.
+     * The density loop is branch free and uses a polynomial exp approximation so that the
+     * compiler can vectorize it. The sqrt loop is only vectorized with -fno-math-errno.
+     * On the generated grids of all supported sizes the error compared to evalSquared is below
+     * 2e-6 of the maximum density, and below 1e-5 relative where the density is above 1e-3 of
+     * the maximum. The relative error grows close to the nodal cone 3 z^2 = r^2.
+     */
+    static void evalSquaredFast(const float* x2, float y2, float z2, float* out, size_t count);
+
+    /**
+     * Associated Laguerre polynomial L_k^alpha(x), from the three term recurrence.
+     */
+    static double associatedLaguerre(int k, int alpha, double x);
+    /**
+     * Associated Legendre polynomial P_l^m(x) for 0 <= m <= l, including the Condon-Shortley
+     * phase, from the three term recurrence in l.
+     */
+    static double associatedLegendre(int l, int m, double x);
+    /**
+     * Coefficients a_i of P_l^m(x)^2 = sum_i a_i x^(2i), i = 0..l, for 0 <= m <= l. The square
+     * only depends on x^2, so it can be evaluated from cos^2(theta) without a square root.
+     */
+    static std::vector<double> associatedLegendreSquared(int l, int m);
+    /**
+     * Normalized radial wave function R_nl(r), with r in Bohr radii.
+     */
+    static double radial(int n, int l, double r);
+    /**
+     * Squared normalization of the spherical harmonic Y_l^m, (2l + 1) / (4 pi) (l - m)! / (l + m)!
+     */
+    static double angularNormSquared(int l, int m);
+    /**
+     * Probability density |psi_nlm|^2 of the orbital (n, l, m). The density of the complex
+     * eigenstate does not depend on the azimuth, so m and -m give the same result.
+     * (3, 2, 0) gives the same values as evalSquared.
+     */
+    static double evalOrbital(int n, int l, int m, vec3 cartesian);
 
     vec3 idTOCartesian(size3_t pos);
+    /**
+     * Same as idTOCartesian(pos) for a volume of size^3 voxels, without reading the size
+     * property. Safe to call from any thread.
+     */
+    static vec3 idTOCartesian(size3_t pos, size_t size);
 
 private:
     VolumeOutport volume_;
 
     IntSizeTProperty size_;
+    OptionProperty<EvaluationMode> evaluationMode_;
+    IntProperty n_;
+    IntProperty l_;
+    IntProperty m_;
+    BoolProperty useCache_;
+    IntSizeTProperty cacheLimit_;  // In MB, least recently used cache files are removed first
+
+    std::future<void> cacheWrite_;  // Pending write of the last generated volume to the cache
 };
 
 }  // namespace inviwo
@@ -5,6 +5,10 @@
 
 #include <modules/tnm067lab2/processors/hydrogengenerator.h>
 
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
 namespace inviwo {
 
 static constexpr std::array<std::pair<vec3, vec3>, 61> toTestSph = {
@@ -153,4 +157,117 @@ TEST(HydrogenTest, eval) {
         EXPECT_NEAR(p.second, res, 0.000000001);
     }
 }
+
+TEST(HydrogenTest, evalSquared) {
+    for (const auto& p : toTestEval) {
+        const dvec3 c(p.first);
+        auto res = HydrogenGenerator::evalSquared(c.x * c.x, c.y * c.y, c.z * c.z);
+        EXPECT_NEAR(p.second, res, 0.000000001);
+    }
+}
+
+TEST(HydrogenTest, evalSquaredFast) {
+    double maxRelativeError = 0.0;
+    for (const auto& p : toTestEval) {
+        const vec3 c(p.first);
+        const float x2 = c.x * c.x;
+        float res = 0.0f;
+        HydrogenGenerator::evalSquaredFast(&x2, c.y * c.y, c.z * c.z, &res, 1);
+        if (p.second == 0.0) {
+            EXPECT_NEAR(p.second, res, 0.000000001);
+        } else {
+            maxRelativeError = std::max(maxRelativeError, std::abs(res - p.second) / p.second);
+        }
+    }
+    EXPECT_LT(maxRelativeError, 1e-4);
+}
+
+TEST(HydrogenTest, evalSquaredFastGrid) {
+    // Fast against Symmetric over the whole generated grid, with the coordinates the processor
+    // uses for both modes
+    for (const size_t size : {16, 33, 128}) {
+        std::vector<float> squared(size);
+        for (size_t i = 0; i < size; ++i) {
+            const float c = HydrogenGenerator::idTOCartesian(size3_t(i), size).x;
+            squared[i] = c * c;
+        }
+
+        std::vector<float> fast(size * size * size);
+        std::vector<double> exact(fast.size());
+        double maxDensity = 0.0;
+        for (size_t z = 0; z < size; ++z) {
+            for (size_t y = 0; y < size; ++y) {
+                const size_t row = (z * size + y) * size;
+                HydrogenGenerator::evalSquaredFast(squared.data(), squared[y], squared[z],
+                                                   fast.data() + row, size);
+                for (size_t x = 0; x < size; ++x) {
+                    const double cx = HydrogenGenerator::idTOCartesian(size3_t(x), size).x;
+                    const double cy = HydrogenGenerator::idTOCartesian(size3_t(y), size).x;
+                    const double cz = HydrogenGenerator::idTOCartesian(size3_t(z), size).x;
+                    exact[row + x] = HydrogenGenerator::evalSquared(cx * cx, cy * cy, cz * cz);
+                    maxDensity = std::max(maxDensity, exact[row + x]);
+                }
+            }
+        }
+
+        double maxError = 0.0;
+        double maxRelativeError = 0.0;
+        for (size_t i = 0; i < fast.size(); ++i) {
+            const double error = std::abs(fast[i] - exact[i]);
+            maxError = std::max(maxError, error);
+            if (exact[i] > 1e-3 * maxDensity) {
+                maxRelativeError = std::max(maxRelativeError, error / exact[i]);
+            }
+        }
+        EXPECT_LT(maxError, 2e-6 * maxDensity) << "size " << size;
+        EXPECT_LT(maxRelativeError, 1e-5) << "size " << size;
+    }
+}
+
+TEST(HydrogenTest, associatedLaguerre) {
+    for (const double x : {0.0, 0.5, 1.5, 4.0}) {
+        EXPECT_NEAR(1.0, HydrogenGenerator::associatedLaguerre(0, 3, x), 1e-12);
+        EXPECT_NEAR(4.0 - x, HydrogenGenerator::associatedLaguerre(1, 3, x), 1e-12);
+        EXPECT_NEAR((x * x - 10.0 * x + 20.0) / 2.0, HydrogenGenerator::associatedLaguerre(2, 3, x),
+                    1e-12);
+    }
+}
+
+TEST(HydrogenTest, associatedLegendre) {
+    for (const double x : {-0.8, -0.3, 0.0, 0.5, 1.0}) {
+        const double s = std::sqrt(1.0 - x * x);
+        EXPECT_NEAR((3.0 * x * x - 1.0) / 2.0, HydrogenGenerator::associatedLegendre(2, 0, x),
+                    1e-12);
+        EXPECT_NEAR(-s, HydrogenGenerator::associatedLegendre(1, 1, x), 1e-12);
+        EXPECT_NEAR(-3.0 * x * s, HydrogenGenerator::associatedLegendre(2, 1, x), 1e-12);
+        EXPECT_NEAR(3.0 * s * s, HydrogenGenerator::associatedLegendre(2, 2, x), 1e-12);
+        EXPECT_NEAR(-1.5 * (5.0 * x * x - 1.0) * s, HydrogenGenerator::associatedLegendre(3, 1, x),
+                    1e-12);
+    }
+}
+
+TEST(HydrogenTest, associatedLegendreSquared) {
+    for (int l = 0; l <= 7; ++l) {
+        for (int m = 0; m <= l; ++m) {
+            const auto coefficients = HydrogenGenerator::associatedLegendreSquared(l, m);
+            ASSERT_EQ(static_cast<size_t>(l + 1), coefficients.size());
+            const double norm = HydrogenGenerator::angularNormSquared(l, m);
+            for (const double x : {-0.9, -0.4, 0.0, 0.3, 0.75, 1.0}) {
+                double res = 0.0;
+                for (size_t i = coefficients.size(); i > 0; --i) {
+                    res = res * x * x + coefficients[i - 1];
+                }
+                const double p = HydrogenGenerator::associatedLegendre(l, m, x);
+                EXPECT_NEAR(norm * p * p, norm * res, 1e-10) << "l " << l << " m " << m;
+            }
+        }
+    }
+}
+
+TEST(HydrogenTest, evalOrbital) {
+    for (const auto& p : toTestEval) {
+        auto res = HydrogenGenerator::evalOrbital(3, 2, 0, p.first);
+        EXPECT_NEAR(p.second, res, 0.000000001);
+    }
+}
 }  // namespace inviwo
\ No newline at end of file